@@ -12,17 +12,269 @@
 
 #include "NN_Key.h"
 
+#if KEY_PACK_SIMD && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#endif
+
 /* ========================= 全局变量定义 ========================= */
 static nn_key_t *_nn_key_list[KEY_MAX_KEY_NUMBER]; // 按键列表
+static nn_key_core_t _nn_key_core[KEY_MAX_KEY_NUMBER]; // 按键运行数据，与按键列表一一对应
+
+#if !KEY_PRIVATE_CONFIG
+// 默认配置模板，未指定模板的按键使用
+static const nn_key_profile_t _nn_key_default_profile = {
+    .profile_id = "default",
+    .key_paras = {
+        .debounce_time = KEY_MS_TO_TICK(KEY_DEBOUNCE_TIME),
+        .long_time = KEY_MS_TO_TICK(KEY_LONG_PRESS_TIME),
+        .long_alws_time = KEY_MS_TO_TICK(KEY_LONG_PRESS_ALWS),
+        .multi_time = KEY_MS_TO_TICK(KEY_MULTI_PRESS_TIME),
+    },
+    .multi_max = 4,
+};
+#endif
 static uint8_t _nn_key_num = 0; //按键数量
 
+#if KEY_USE_COMBO
 static nn_comb_t *_nn_combo_list[KEY_MAX_COMBO_NUMBER]; //组合键列表
 static uint8_t _nn_combo_num = 0; //组合键数量
+#endif
+
+#if KEY_POOL_KEY_NUMBER > 0
+static nn_key_t _nn_key_pool[KEY_POOL_KEY_NUMBER]; // 按键对象池，对象连续存放
+static uint8_t _nn_key_pool_free[KEY_POOL_KEY_NUMBER]; // 已释放的对象序号栈
+static uint8_t _nn_key_pool_top = 0; // 已释放的对象数
+static uint8_t _nn_key_pool_used = 0; // 从未分配过的对象从此序号开始
+#endif
+
+#if KEY_USE_COMBO && KEY_POOL_COMBO_NUMBER > 0
+static nn_comb_t _nn_combo_pool[KEY_POOL_COMBO_NUMBER]; // 组合键对象池，对象连续存放
+static uint8_t _nn_combo_pool_free[KEY_POOL_COMBO_NUMBER]; // 已释放的对象序号栈
+static uint8_t _nn_combo_pool_top = 0; // 已释放的对象数
+static uint8_t _nn_combo_pool_used = 0; // 从未分配过的对象从此序号开始
+#endif
+
+#if KEY_USE_SECTION
+/* 静态注册段的起止地址由链接器生成，没有任何注册项时弱引用为NULL */
+extern const nn_key_reg_t __start_nn_key_reg[] __attribute__((weak));
+extern const nn_key_reg_t __stop_nn_key_reg[] __attribute__((weak));
+#if KEY_USE_COMBO
+extern const nn_comb_reg_t __start_nn_comb_reg[] __attribute__((weak));
+extern const nn_comb_reg_t __stop_nn_comb_reg[] __attribute__((weak));
+#endif
+
+static bool _nn_key_reg_done = false; // 静态注册项是否已添加
+#endif
+
+static nn_key_group_t *_nn_group_list[KEY_MAX_GROUP_NUMBER]; // 采样分组列表
+static uint8_t _nn_group_num = 0; // 采样分组数量
+
+#if KEY_ID_HASH_SIZE > 0
+#if (KEY_ID_HASH_SIZE & (KEY_ID_HASH_SIZE - 1)) || KEY_ID_HASH_SIZE <= KEY_MAX_KEY_NUMBER || KEY_ID_HASH_SIZE <= KEY_MAX_COMBO_NUMBER
+#error "KEY_ID_HASH_SIZE must be a power of two greater than KEY_MAX_KEY_NUMBER and KEY_MAX_COMBO_NUMBER"
+#endif
+// ID哈希表，线性探测，每槽存放序号+1，0为空槽
+static uint8_t _nn_key_id_hash[KEY_ID_HASH_SIZE]; // 按键ID哈希表
+#if KEY_USE_COMBO
+static uint8_t _nn_combo_id_hash[KEY_ID_HASH_SIZE]; // 组合键ID哈希表
+#endif
+#endif
+
+static uint32_t _nn_key_port_last[KEY_PORT_WORDS]; // 上一次采样的电平位图，第i位对应第i个按键
+static uint32_t _nn_key_idle_mask[KEY_PORT_WORDS]; // 空闲按键位图，空闲按键电平不变时无需运行状态机
+static uint32_t _nn_key_sample_mask[KEY_PORT_WORDS]; // 需逐次采样的按键位图(未初始化或按采样次数消抖)
+static uint32_t _nn_key_touch[KEY_PORT_WORDS]; // 本轮运行过状态机、待分发事件的按键位图
+static uint32_t _nn_key_parked[KEY_PORT_WORDS]; // 截止时刻已过、等待限额轮转轮到的按键位图，不在时间轮中
+
+/* 超时时间轮: 每层32格，第k层每格跨度为2^(5k)个tick */
+#define _NN_WHEEL_BITS 5
+#define _NN_WHEEL_MASK 31
+
+static nn_key_timer_t *_nn_wheel[KEY_WHEEL_LEVELS][1 << _NN_WHEEL_BITS]; // 各格的定时器链表
+static uint32_t _nn_wheel_map[KEY_WHEEL_LEVELS]; // 各层非空格位图
+static nn_key_tick_t _nn_wheel_base = 0; // 时间轮当前时刻，早于它的定时器均已取出
+static uint16_t _nn_wheel_count = 0; // 时间轮中的定时器数量
+
+/**
+ * @brief 中断边沿记录
+ */
+typedef struct
+{
+    nn_key_tick_t tick; // 边沿时间戳
+    uint8_t index; // 按键序号
+    bool level; // 边沿后的电平
+} nn_key_edge_t;
+
+static volatile nn_key_edge_t _nn_key_edge_fifo[KEY_EDGE_FIFO_SIZE]; // 边沿环形缓冲区
+static volatile uint16_t _nn_key_edge_head = 0; // 写位置，仅由中断修改
+static volatile uint16_t _nn_key_edge_tail = 0; // 读位置，仅由处理函数修改
+static uint8_t _nn_key_edge_num = 0; // 已添加的边沿驱动按键数量
+
+static uint32_t _nn_key_sbuf_port[2][KEY_SAMPLE_BUF_SIZE][KEY_PORT_WORDS]; // 采样双缓冲区的端口快照
+static nn_key_tick_t _nn_key_sbuf_tick[2][KEY_SAMPLE_BUF_SIZE]; // 采样双缓冲区的时间戳
+static volatile uint16_t _nn_key_sbuf_count[2] = {0}; // 各半区的采样数
+static volatile uint8_t _nn_key_sbuf_write = 0; // 采样阶段写入的半区，仅由采样函数修改
+static volatile bool _nn_key_sbuf_ready = false; // 另一半区已交给处理阶段，由采样函数置位、处理函数清除
+
+static uint8_t _nn_key_rr_next = 0; // 限额处理下次开始的按键序号
+static uint8_t _nn_key_rr_calls = 0; // 限额处理保证每个按键被处理的最大调用间隔，0为不限制
+
+static nn_key_tick_t _nn_key_last_tick = 0; // 上一次处理事件的时刻
+#if KEY_USE_LONG_ALWS
+static nn_key_tick_t _nn_key_alws_last = 0; // 上次持续长按回调的时间
+#endif
+static nn_key_span_t _nn_key_catchup_gap = 0; // 自动追赶的间隔阈值(tick)，0为关闭
+
+static uint32_t _nn_key_jitter_hist[KEY_JITTER_BUCKETS]; // 调用间隔直方图
+static nn_key_jitter_t _nn_key_jitter = {0}; // 调用间隔统计
+static nn_key_tick_t _nn_key_poll_last = 0; // 上一次调用处理函数的时刻
+static bool _nn_key_poll_valid = false; // 是否已有上一次调用的时刻
+static bool _nn_key_jitter_comp = false; // 是否开启调用抖动补偿
+
+/* 状态转换表: 由(当前状态, 消抖后电平, 截止时刻类别)查得下一状态和动作，两个引擎共用 */
+
+/**
+ * @brief 截止时刻类别
+ * @note 按优先级从高到低排列，多个截止时刻同时到达时取转换表中有对应项的最高优先级类别
+ */
+enum
+{
+    _NN_KEY_CLS_NONE = 0, // 无截止时刻到达
+    _NN_KEY_CLS_HOLD, // 按住达到长按截止时间(KEY_OPT_LONG_ON_HOLD)
+    _NN_KEY_CLS_ALWS, // 按下时长达到持续长按阈值(持续长按已开启)
+    _NN_KEY_CLS_STAGE, // 按下时长达到长按阈值(持续长按已开启)
+    _NN_KEY_CLS_LONG, // 按下时长达到长按阈值
+    _NN_KEY_CLS_MULTI, // 释放时长达到连按间隔
+    _NN_KEY_CLS_MAX
+};
+
+/**
+ * @brief 状态转换动作
+ */
+enum
+{
+    _NN_KEY_ACT_STAY = 0, // 保持当前状态，转换表中未列出的输入均为此动作
+    _NN_KEY_ACT_MOVE, // 只切换状态
+    _NN_KEY_ACT_SETTLE, // 初始电平为释放
+    _NN_KEY_ACT_PRESS, // 开始新的按下手势
+    _NN_KEY_ACT_CLICK, // 短按释放，进入连按检测
+    _NN_KEY_ACT_LONG_UP, // 按下状态释放时已达长按阈值
+    _NN_KEY_ACT_LONG_HOLD, // 按住达到长按阈值，立即触发长按
+    _NN_KEY_ACT_ALWS, // 进入持续长按
+    _NN_KEY_ACT_LONG_END, // 长按状态释放
+    _NN_KEY_ACT_ALWS_END, // 持续长按状态释放
+    _NN_KEY_ACT_ALWS_HOLD, // 持续长按保持
+    _NN_KEY_ACT_REPRESS, // 连按窗口内再次按下
+    _NN_KEY_ACT_MULTI_END, // 连按窗口结束，按次数产生事件
+    _NN_KEY_ACT_TAP, // 短按释放，未编译连按检测时立即产生单击
+    _NN_KEY_ACT_RESET, // 未知状态，回到初始状态
+};
+
+/**
+ * 持续长按是否开启，未编译持续长按功能时恒为false
+ */
+#define _NN_KEY_ALWS_ON(paras) (KEY_USE_LONG_ALWS && (paras)->long_alws_time > 0)
+
+/**
+ * 连按检测的转换，未编译时短按释放直接回到释放状态
+ */
+#if KEY_USE_MULTI
+#define _NN_KEY_TRANSITIONS_MULTI(X)                                   \
+    X(PRESSED, 0, NONE, MULTI_PRESSED, CLICK)                          \
+    X(MULTI_PRESSED, 0, MULTI, RELEASED, MULTI_END)                    \
+    X(MULTI_PRESSED, 1, NONE, PRESSED, REPRESS)
+#else
+#define _NN_KEY_TRANSITIONS_MULTI(X) X(PRESSED, 0, NONE, RELEASED, TAP)
+#endif
+
+/**
+ * 持续长按的转换
+ */
+#if KEY_USE_LONG_ALWS
+#define _NN_KEY_TRANSITIONS_ALWS(X)                                    \
+    X(PRESSED, 1, ALWS, LONG_PRESSED_ALWS, ALWS)                       \
+    X(PRESSED, 1, STAGE, LONG_PRESSED, MOVE)                           \
+    X(LONG_PRESSED, 1, ALWS, LONG_PRESSED_ALWS, ALWS)                  \
+    X(LONG_PRESSED_ALWS, 0, NONE, RELEASED, ALWS_END)                  \
+    X(LONG_PRESSED_ALWS, 1, NONE, LONG_PRESSED_ALWS, ALWS_HOLD)
+#else
+#define _NN_KEY_TRANSITIONS_ALWS(X)
+#endif
+
+/**
+ * 状态转换说明: X(当前状态, 消抖后电平, 截止时刻类别, 下一状态, 动作)
+ * 新增状态或转换只需在此添加行，未列出的输入保持当前状态
+ */
+#define _NN_KEY_TRANSITIONS(X)                                         \
+    X(INIT, 0, NONE, RELEASED, SETTLE)                                 \
+    X(INIT, 1, NONE, PRESSED, PRESS)                                   \
+    X(RELEASED, 1, NONE, PRESSED, PRESS)                               \
+    X(PRESSED, 0, LONG, RELEASED, LONG_UP)                             \
+    X(PRESSED, 1, HOLD, LONG_PRESSED, LONG_HOLD)                       \
+    X(LONG_PRESSED, 0, NONE, RELEASED, LONG_END)                       \
+    _NN_KEY_TRANSITIONS_MULTI(X)                                       \
+    _NN_KEY_TRANSITIONS_ALWS(X)
+
+/**
+ * @brief 状态转换表项
+ */
+typedef struct
+{
+    uint8_t next:3; // 下一状态
+    uint8_t action:5; // 转换动作
+} nn_key_trans_t;
+
+#define _NN_KEY_TRANS_ROW(state, level, cls, next, action) \
+    [KEY_STATE_##state][level][_NN_KEY_CLS_##cls] = {KEY_STATE_##next, _NN_KEY_ACT_##action},
+
+static const nn_key_trans_t _nn_key_trans[KEY_STATE_MULTI_PRESSED + 1][2][_NN_KEY_CLS_MAX] = {
+    _NN_KEY_TRANSITIONS(_NN_KEY_TRANS_ROW)
+};
+
+static const nn_key_trans_t _nn_key_trans_reset = {KEY_STATE_INIT, _NN_KEY_ACT_RESET}; // 未知状态的转换
 
 /* ========================= 内部函数声明 ========================= */
-static bool _NN_Key_Event(nn_key_t *key, uint32_t tick);
-static void _NN_Key_StateMachine(nn_key_t *key, uint32_t tick);
-static void _NN_Combo_Process(uint32_t tick);
+static bool _NN_Key_Event(nn_key_t *key, nn_key_tick_t tick);
+static bool _NN_Key_Debounce(nn_key_t *key, bool raw, nn_key_tick_t tick);
+static void _NN_Key_BounceUpdate(nn_key_t *key);
+static void _NN_Key_StateMachine(nn_key_t *key, nn_key_tick_t tick, bool raw);
+static const nn_key_trans_t *_NN_Key_Transition(uint8_t state, bool level, uint8_t hit);
+static bool _NN_Key_IsIdle(const nn_key_core_t *core);
+static bool _NN_Key_Listed(const nn_key_t *key);
+static void _NN_Key_MaskUpdate(uint8_t index);
+static void _NN_Key_CoreInit(nn_key_t *key);
+static bool _NN_Key_Dispatch(nn_key_tick_t tick);
+static bool _NN_Key_EdgeDrain(nn_key_tick_t tick);
+static bool _NN_Key_NextDeadline(nn_key_t *key, nn_key_tick_t *deadline);
+static void _NN_Key_JitterRecord(nn_key_tick_t tick);
+static bool _NN_Key_Sample(const uint32_t *ports, nn_key_tick_t tick);
+static void _NN_Key_Poll(uint8_t index, nn_key_tick_t tick);
+static void _NN_Key_GroupSchedule(nn_key_group_t *group, nn_key_tick_t tick);
+static nn_key_profile_t *_NN_Key_OwnProfile(nn_key_t *key);
+static void _NN_Key_TimerArm(nn_key_t *key);
+#if KEY_USE_COMBO
+static bool _NN_Combo_Setup(nn_comb_t *comb, const char *id, uint8_t mem_nbr, nn_key_t *const *members);
+static void _NN_Combo_Process(nn_key_tick_t tick);
+static void _NN_Combo_TimerArm(nn_comb_t *comb);
+#endif
+static void _NN_Key_TimerSettle(nn_key_tick_t tick, bool park);
+static void _NN_Wheel_Insert(nn_key_timer_t *timer, nn_key_tick_t expire);
+static void _NN_Wheel_Remove(nn_key_timer_t *timer);
+static bool _NN_Wheel_Peek(nn_key_tick_t *when);
+static bool _NN_Wheel_Next(nn_key_tick_t limit, nn_key_tick_t *when);
+static nn_key_timer_t *_NN_Wheel_Pop(void);
+static uint32_t _NN_Key_IdHash(const char *id);
+static uint8_t _NN_Key_PhashSlot(uint32_t hash, uint16_t disp, uint8_t count);
+#if KEY_ID_HASH_SIZE > 0
+static const char *_NN_Key_IdOf(bool is_combo, uint8_t index);
+static void _NN_Key_IdInsert(uint8_t *table, const char *id, uint8_t index);
+static void _NN_Key_IdErase(uint8_t *table, bool is_combo, const char *id, uint8_t index);
+static int16_t _NN_Key_IdFind(const uint8_t *table, bool is_combo, const char *id);
+#endif
+static void _NN_KeyPack_Step(nn_keypack_t *pack, uint16_t index, uint16_t now, bool raw);
+static void _NN_KeyPack_Event(nn_keypack_t *pack, uint16_t index, nn_key_tick_t tick);
+static bool _NN_KeyPack_Deadline(nn_keypack_t *pack, uint16_t index, uint16_t now, bool raw);
+static uint32_t _NN_KeyPack_Expired(const uint16_t *due, uint16_t now);
 
 /* ========================= 基础按键函数实现 ========================= */
 /**
@@ -31,44 +283,93 @@ static void _NN_Combo_Process(uint32_t tick);
  * @param name 按键名称
  * @param pfunc 按键读取函数
  * @return 初始化是否成功
- * @note 此函数会设置按键的默认参数和状态
+ * @note 此函数会设置按键的默认参数和状态；运行数据在NN_Key_Add时才分配，
+ *       未添加的按键没有运行数据，不能调用设置函数(返回false)，也不会被处理
+ *       对已添加的按键调用时就地重新初始化，按键保留在列表中的位置
  */
 bool NN_Key_Init(nn_key_t *key, const char *name, nn_key_read_t pfunc)
 {
+    int16_t index;
+
     if (key == NULL) return false;
 
-    // 按键基础信息
+    // 按键基础信息，已添加的按键改名时同步更新ID哈希表
+    index = _NN_Key_Listed(key) ? key->key_timer.index : -1;
+#if KEY_ID_HASH_SIZE > 0
+    if (index >= 0) _NN_Key_IdErase(_nn_key_id_hash, false, key->key_id, (uint8_t)index);
+#endif
     key->key_id = name; // 按键ID
+#if KEY_ID_HASH_SIZE > 0
+    if (index >= 0) _NN_Key_IdInsert(_nn_key_id_hash, name, (uint8_t)index);
+#endif
     key->key_read = pfunc; // 读取按键函数
-    key->key_last_time = 0; // 按键上一次事件时间
+    key->key_group = NULL;
+#if KEY_PRIVATE_CONFIG
+    NN_Key_ProfileInit(&key->key_own, name);
+#endif
 
-    // 初始化参数
-    key->key_paras.debounce_time = KEY_DEBOUNCE_TIME; // 消抖时间
-    key->key_paras.long_time = KEY_LONG_PRESS_TIME; // 长按时间
-    key->key_paras.long_alws_time = KEY_LONG_PRESS_ALWS; // 持续长按时间
-    key->key_paras.multi_time = KEY_MULTI_PRESS_TIME; // 连按时间
+    // 未添加的按键不占用运行数据，NN_Key_Add时再分配
+    if (index < 0)
+    {
+        key->key_core = NULL;
+        memset(&key->key_timer, 0, sizeof(key->key_timer));
+        return true;
+    }
 
-    // 初始化标志位
-    key->key_flags.state = KEY_STATE_INIT; // 初始状态
-    key->key_flags.event = KEY_EVENT_INIT; // 初始事件
-    key->key_flags.lock_flag = false; // 锁定标志，用于组合键处理
-    key->key_flags.is_member = false; // 是否为组合键成员
+    // 已添加的按键就地重置运行数据，可能有未到期的定时器或等待轮到的截止时刻
+    _NN_Wheel_Remove(&key->key_timer);
+    _nn_key_parked[index >> 5] &= ~(1UL << (index & 31));
+    if (key->key_core->key_opts & KEY_OPT_EDGE_SOURCE) _nn_key_edge_num--;
+    _NN_Key_CoreInit(key);
 
-    //初始化多击相关
-    key->key_multi_paras.multi_max = 4; // 最大连按次数
-    key->key_multi_paras.multi_count = 0; // 连按计数
+    // 回到初始状态，需重新逐次采样
+    _NN_Key_MaskUpdate((uint8_t)index);
 
-    // 初始化回调掩码和回调数组
-    key->callback_mask = 0;
+    return true;
+}
 
-    // 初始化所有回调函数指针和用户数据
-    for (uint8_t i = 0; i < KEY_EVENT_MAX; i++)
-    {
-        key->callbacks[i].func.callback_key = NULL;
-        key->callbacks[i].user_data = NULL;
-    }
+/**
+ * @brief 初始化按键的运行数据
+ * @param key 按键指针，key_core和key_timer.index已指向分配的位置
+ * @note 内部函数，由NN_Key_Init和NN_Key_Add调用
+ */
+static void _NN_Key_CoreInit(nn_key_t *key)
+{
+    nn_key_core_t *core = key->key_core;
+    uint8_t index = key->key_timer.index;
 
-    return true;
+    core->key_last_time = 0; // 按键上一次事件时间
+    core->key_deadline = 0; // 长按截止时间
+    memset(&key->key_timer, 0, sizeof(key->key_timer)); // 截止时刻定时器
+    key->key_timer.index = index;
+
+    // 初始化参数和回调表，默认使用私有配置
+#if KEY_PRIVATE_CONFIG
+    core->key_profile = &key->key_own;
+#else
+    core->key_profile = &_nn_key_default_profile;
+#endif
+
+    // 初始化标志位
+    core->key_flags.state = KEY_STATE_INIT; // 初始状态
+    core->key_flags.event = KEY_EVENT_INIT; // 初始事件
+    core->key_flags.lock_flag = false; // 锁定标志，用于组合键处理
+    core->key_flags.is_member = false; // 是否为组合键成员
+
+    //初始化多击相关
+    core->key_multi_paras.multi_count = 0; // 连按计数
+
+    // 初始化消抖相关，默认使用时间锁定策略
+    memset(&core->key_debounce, 0, sizeof(core->key_debounce));
+    core->key_debounce.mode = KEY_DEBOUNCE_LOCKOUT;
+    core->key_debounce.press_time = core->key_profile->key_paras.debounce_time;
+    memset(&key->key_tune, 0, sizeof(key->key_tune));
+    key->key_tune.samples = KEY_DEBOUNCE_SAMPLES;
+    key->key_tune.release_time = KEY_MS_TO_TICK(KEY_DEBOUNCE_TIME);
+
+    // 初始化选项
+    core->key_opts = KEY_OPT_NONE;
+    core->key_seq = 0;
 }
 
 /**
@@ -84,15 +385,194 @@ bool NN_Key_Add(nn_key_t *key, const char *id, nn_key_read_t read_func)
     // 参数检查
     if (key == NULL || read_func == NULL || _nn_key_num >= KEY_MAX_KEY_NUMBER) return false;
 
-    // 初始化按键
-    if (!NN_Key_Init(key, id, read_func)) return false;
+    // 已添加的按键不能重复添加
+    if (_NN_Key_Listed(key)) return false;
 
-    // 添加到按键列表
+    // 初始化按键并分配运行数据
+    if (!NN_Key_Init(key, id, read_func)) return false;
+    key->key_core = &_nn_key_core[_nn_key_num];
+    key->key_timer.index = _nn_key_num;
+    _NN_Key_CoreInit(key);
+
+    // 添加到按键列表，未初始化的按键需逐次采样
+    _nn_key_sample_mask[_nn_key_num >> 5] |= (1UL << (_nn_key_num & 31));
+#if KEY_ID_HASH_SIZE > 0
+    _NN_Key_IdInsert(_nn_key_id_hash, id, _nn_key_num);
+#endif
     _nn_key_list[_nn_key_num++] = key;
 
     return true;
 }
 
+/**
+ * @brief 按描述表批量添加按键
+ * @param keys 与描述表一一对应的按键数组，由调用者提供(可放在.bss中)
+ * @param table 按键描述表，可声明为const放在Flash中
+ * @param count 表项数
+ * @return 添加是否成功，剩余容量不足、有表项缺少读取函数或有按键已添加时不添加任何按键
+ * @note 按键的ID、读取函数、参数和回调均来自描述表和其中的配置模板，
+ *       运行数据只需整体清零再填入少量非零字段，适合按键较多时快速启动
+ *       添加后仍可用NN_Key_SetDebounce、NN_Key_SetOpt等接口单独调整
+ */
+bool NN_Key_AddTable(nn_key_t *keys, const nn_key_desc_t *table, uint8_t count)
+{
+    nn_key_core_t *core;
+
+    if (keys == NULL || table == NULL || count > KEY_MAX_KEY_NUMBER - _nn_key_num) return false;
+
+    // 已添加的按键不能重复添加，数组中的按键各不相同，只需逐个检查是否已在列表中
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (table[i].key_read == NULL || _NN_Key_Listed(&keys[i])) return false;
+    }
+
+    // 状态、事件、计数和定时器的初始值均为0
+    core = &_nn_key_core[_nn_key_num];
+    memset(core, 0, count * sizeof(nn_key_core_t));
+    memset(keys, 0, count * sizeof(nn_key_t));
+
+    for (uint8_t i = 0; i < count; i++, core++)
+    {
+        nn_key_t *key = &keys[i];
+
+        key->key_core = core;
+        key->key_id = table[i].key_id;
+        key->key_read = table[i].key_read;
+        key->key_timer.index = _nn_key_num;
+
+        // 未指定模板时使用默认参数
+        if (table[i].key_profile != NULL)
+        {
+            core->key_profile = table[i].key_profile;
+        }
+        else
+        {
+#if KEY_PRIVATE_CONFIG
+            NN_Key_ProfileInit(&key->key_own, key->key_id);
+            core->key_profile = &key->key_own;
+#else
+            core->key_profile = &_nn_key_default_profile;
+#endif
+        }
+
+        core->key_debounce.press_time = core->key_profile->key_paras.debounce_time;
+        key->key_tune.samples = KEY_DEBOUNCE_SAMPLES;
+        key->key_tune.release_time = KEY_MS_TO_TICK(KEY_DEBOUNCE_TIME);
+
+        // 添加到按键列表，未初始化的按键需逐次采样
+        _nn_key_sample_mask[_nn_key_num >> 5] |= (1UL << (_nn_key_num & 31));
+#if KEY_ID_HASH_SIZE > 0
+        _NN_Key_IdInsert(_nn_key_id_hash, key->key_id, _nn_key_num);
+#endif
+        _nn_key_list[_nn_key_num++] = key;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 从按键列表中删除按键
+ * @param key 按键指针
+ * @return 删除是否成功，按键未添加或仍是组合键成员时返回false
+ * @note 最后一个按键移到被删除按键的位置，其序号会改变；删除后按键不能再使用，除非重新添加
+ *       删除前应确保中断不会再为该序号推送边沿或采样
+ */
+bool NN_Key_Remove(nn_key_t *key)
+{
+    uint8_t index;
+    uint8_t last;
+
+    if (key == NULL) return false;
+
+    // 定时器序号即按键在列表中的位置
+    index = key->key_timer.index;
+    if (index >= _nn_key_num || _nn_key_list[index] != key) return false;
+    if (key->key_core->key_flags.is_member) return false;
+
+    _NN_Wheel_Remove(&key->key_timer);
+    if (key->key_core->key_opts & KEY_OPT_EDGE_SOURCE) _nn_key_edge_num--;
+
+    // 最后一个按键的运行数据和位图位移到空出的位置
+    last = (uint8_t)(_nn_key_num - 1);
+#if KEY_ID_HASH_SIZE > 0
+    _NN_Key_IdErase(_nn_key_id_hash, false, key->key_id, index);
+    if (index != last)
+    {
+        _NN_Key_IdErase(_nn_key_id_hash, false, _nn_key_list[last]->key_id, last);
+        _NN_Key_IdInsert(_nn_key_id_hash, _nn_key_list[last]->key_id, index);
+    }
+#endif
+    if (index != last)
+    {
+        nn_key_t *moved = _nn_key_list[last];
+        uint32_t bit = 1UL << (index & 31);
+        bool level = (_nn_key_port_last[last >> 5] >> (last & 31)) & 1;
+        bool idle = (_nn_key_idle_mask[last >> 5] >> (last & 31)) & 1;
+        bool sample = (_nn_key_sample_mask[last >> 5] >> (last & 31)) & 1;
+        bool touch = (_nn_key_touch[last >> 5] >> (last & 31)) & 1;
+        bool parked = (_nn_key_parked[last >> 5] >> (last & 31)) & 1;
+
+        _nn_key_core[index] = _nn_key_core[last];
+        moved->key_core = &_nn_key_core[index];
+        moved->key_timer.index = index;
+        _nn_key_list[index] = moved;
+
+        _nn_key_port_last[index >> 5] = level ? (_nn_key_port_last[index >> 5] | bit) : (_nn_key_port_last[index >> 5] & ~bit);
+        _nn_key_idle_mask[index >> 5] = idle ? (_nn_key_idle_mask[index >> 5] | bit) : (_nn_key_idle_mask[index >> 5] & ~bit);
+        _nn_key_sample_mask[index >> 5] = sample ? (_nn_key_sample_mask[index >> 5] | bit) : (_nn_key_sample_mask[index >> 5] & ~bit);
+        _nn_key_touch[index >> 5] = touch ? (_nn_key_touch[index >> 5] | bit) : (_nn_key_touch[index >> 5] & ~bit);
+        _nn_key_parked[index >> 5] = parked ? (_nn_key_parked[index >> 5] | bit) : (_nn_key_parked[index >> 5] & ~bit);
+    }
+
+    _nn_key_port_last[last >> 5] &= ~(1UL << (last & 31));
+    _nn_key_idle_mask[last >> 5] &= ~(1UL << (last & 31));
+    _nn_key_sample_mask[last >> 5] &= ~(1UL << (last & 31));
+    _nn_key_touch[last >> 5] &= ~(1UL << (last & 31));
+    _nn_key_parked[last >> 5] &= ~(1UL << (last & 31));
+    _nn_key_list[last] = NULL;
+    _nn_key_num--;
+
+    if (_nn_key_rr_next >= _nn_key_num) _nn_key_rr_next = 0;
+    key->key_core = NULL;
+
+    return true;
+}
+
+#if KEY_USE_SECTION
+/**
+ * @brief 添加所有静态注册的按键和组合键
+ * @return 是否全部添加成功，成员按键添加失败的组合键不添加
+ * @note 先添加NN_KEY_REGISTER注册的按键，再添加NN_COMBO_REGISTER注册的组合键，段内顺序由编译器和链接器决定；
+ *       只在第一次调用时添加，处理函数首次调用时会自动调用，需在此之前配置按键时可提前手动调用
+ */
+bool NN_Key_RegisterAll(void)
+{
+    bool result = true;
+
+    if (_nn_key_reg_done) return true;
+    _nn_key_reg_done = true;
+
+    for (const nn_key_reg_t *reg = __start_nn_key_reg; reg < __stop_nn_key_reg; reg++)
+    {
+        result &= NN_Key_AddTable(reg->key, &reg->desc, 1);
+    }
+
+#if KEY_USE_COMBO
+    for (const nn_comb_reg_t *reg = __start_nn_comb_reg; reg < __stop_nn_comb_reg; reg++)
+    {
+        if (!_NN_Combo_Setup(reg->comb, reg->combo_id, reg->member_num, reg->members))
+        {
+            result = false;
+            continue;
+        }
+        if (reg->cb != NULL) NN_Combo_SetCb(reg->comb, reg->cb, reg->user_data);
+    }
+#endif
+
+    return result;
+}
+#endif
+
 /**
  * @brief 设置按键参数
  * @param key 按键指针
@@ -103,6 +583,8 @@ bool NN_Key_Add(nn_key_t *key, const char *id, nn_key_read_t read_func)
  * @param multi_max 最大连按次数
  * @return 设置是否成功
  * @note 传入0表示不修改该参数
+ *       使用共享模板的按键修改消抖以外的参数时，会先复制一份私有配置，不影响模板和其他按键
+ *       KEY_PRIVATE_CONFIG为0时只能修改消抖时间，其余参数需通过模板修改
  */
 bool NN_Key_SetPara(nn_key_t *key,
                     uint16_t debounce_time,
@@ -111,18 +593,251 @@ bool NN_Key_SetPara(nn_key_t *key,
                     uint16_t multi_time,
                     uint8_t multi_max)
 {
-    if (key == NULL) return false;
+    nn_key_profile_t *own = NULL;
+
+    if (key == NULL || key->key_core == NULL) return false;
+
+    // 消抖时间属于按键自身，其余参数写入私有配置
+    if (long_time || long_alws_time || multi_time || multi_max)
+    {
+        own = _NN_Key_OwnProfile(key);
+        if (own == NULL) return false;
+    }
+
+    // 配置时换算为tick，处理过程中不再做单位换算
+    if (debounce_time) key->key_core->key_debounce.press_time = KEY_MS_TO_TICK(debounce_time);
+    if (long_time) own->key_paras.long_time = KEY_MS_TO_TICK(long_time);
+    if (long_alws_time) own->key_paras.long_alws_time = KEY_MS_TO_TICK(long_alws_time);
+    if (multi_time) own->key_paras.multi_time = KEY_MS_TO_TICK(multi_time);
+    if (multi_max) own->multi_max = (multi_max > 15 ? 15 : multi_max); // 连按计数为4位位域，最大值为15
+    _NN_Key_TimerArm(key);
+
+    return true;
+}
+
+/**
+ * @brief 以tick为单位设置按键时间参数
+ * @param key 按键指针
+ * @param debounce_time 消抖时间(tick)
+ * @param long_time 长按时间(tick)
+ * @param long_alws_time 持续长按时间(tick)
+ * @param multi_time 连按间隔时间(tick)
+ * @return 设置是否成功
+ * @note 传入0表示不修改该参数，用于us时基下的精细设置或超过65s的长按时间
+ *       与NN_Key_SetPara相同，修改消抖以外的参数时使用私有配置
+ */
+bool NN_Key_SetParaTick(nn_key_t *key,
+                        nn_key_span_t debounce_time,
+                        nn_key_span_t long_time,
+                        nn_key_span_t long_alws_time,
+                        nn_key_span_t multi_time)
+{
+    nn_key_profile_t *own = NULL;
+
+    if (key == NULL || key->key_core == NULL) return false;
+
+    if (long_time || long_alws_time || multi_time)
+    {
+        own = _NN_Key_OwnProfile(key);
+        if (own == NULL) return false;
+    }
+
+    if (debounce_time) key->key_core->key_debounce.press_time = debounce_time;
+    if (long_time) own->key_paras.long_time = long_time;
+    if (long_alws_time) own->key_paras.long_alws_time = long_alws_time;
+    if (multi_time) own->key_paras.multi_time = multi_time;
+    _NN_Key_TimerArm(key);
+
+    return true;
+}
+
+/**
+ * @brief 设置按键选项
+ * @param key 按键指针
+ * @param opt 选项，见nn_key_opt_t，可按位组合
+ * @param enable true: 开启, false: 关闭
+ * @return 设置是否成功
+ */
+bool NN_Key_SetOpt(nn_key_t *key, nn_key_opt_t opt, bool enable)
+{
+    uint8_t old;
+
+    if (key == NULL || key->key_core == NULL) return false;
+
+    old = key->key_core->key_opts;
+    if (enable)
+    {
+        key->key_core->key_opts |= (uint8_t)opt;
+    }
+    else
+    {
+        key->key_core->key_opts &= (uint8_t)~opt;
+    }
+
+    // 统计边沿驱动按键，处理函数据此决定是否按实际时刻结算截止时刻
+    if (_NN_Key_Listed(key) && ((old ^ key->key_core->key_opts) & KEY_OPT_EDGE_SOURCE))
+    {
+        if (old & KEY_OPT_EDGE_SOURCE)
+        {
+            _nn_key_edge_num--;
+        }
+        else
+        {
+            _nn_key_edge_num++;
+        }
+    }
+    _NN_Key_TimerArm(key);
+
+    return true;
+}
+
+/**
+ * @brief 设置按键消抖策略
+ * @param key 按键指针
+ * @param mode 消抖策略
+ * @param press_para 时间类策略为按下消抖时间(ms)，积分/移位策略为采样数(1~16)
+ * @param release_para 释放消抖时间(ms)，仅非对称策略使用
+ * @return 设置是否成功
+ * @note 传入0表示不修改该参数，建议在NN_Key_Add之后立即调用
+ */
+bool NN_Key_SetDebounce(nn_key_t *key, nn_key_debounce_t mode, uint16_t press_para, uint16_t release_para)
+{
+    if (key == NULL || key->key_core == NULL || mode > KEY_DEBOUNCE_ASYMMETRIC) return false;
+
+    key->key_core->key_debounce.mode = mode;
+
+    if (mode == KEY_DEBOUNCE_INTEGRATOR || mode == KEY_DEBOUNCE_SHIFT)
+    {
+        if (press_para) key->key_tune.samples = (press_para > 16 ? 16 : (uint8_t)press_para); // 移位寄存器为16位
+    }
+    else if (press_para)
+    {
+        key->key_core->key_debounce.press_time = KEY_MS_TO_TICK(press_para);
+    }
+    if (release_para) key->key_tune.release_time = KEY_MS_TO_TICK(release_para);
+
+    // 释放不滤波的策略无法测量释放抖动，关闭自适应消抖
+    if (mode != KEY_DEBOUNCE_EAGER && mode != KEY_DEBOUNCE_ASYMMETRIC)
+    {
+        key->key_core->key_opts &= (uint8_t)~KEY_OPT_ADAPTIVE_DEBOUNCE;
+        key->key_core->key_debounce.measuring = false;
+    }
+
+    // 以当前稳定电平重置滤波器，避免切换策略时产生虚假跳变
+    key->key_core->key_debounce.count = key->key_core->key_debounce.level ? key->key_tune.samples : 0;
+    key->key_core->key_debounce.history = key->key_core->key_debounce.level ? 0xFFFF : 0;
+    if (_NN_Key_Listed(key)) _NN_Key_MaskUpdate(key->key_timer.index);
+    _NN_Key_TimerArm(key);
+
+    return true;
+}
+
+/**
+ * @brief 开启或关闭自适应消抖
+ * @param key 按键指针
+ * @param min_time 消抖时间下限(ms)
+ * @param max_time 消抖时间上限(ms)，同时作为每次跳变后的抖动测量窗口
+ * @return 设置是否成功
+ * @note min_time与max_time均为0时关闭自适应消抖
+ *       抖动估计值以当前消抖时间为初值，需恢复已保存的调优值时，
+ *       应先调用NN_Key_SetDebounceTime再调用本函数
+ *       只支持按下和释放都滤波的抢先/非对称策略，需先用NN_Key_SetDebounce切换；
+ *       锁定策略的释放立即生效，按住时的抖动会打断测量，使估计值偏小
+ */
+bool NN_Key_SetAdaptiveDebounce(nn_key_t *key, uint16_t min_time, uint16_t max_time)
+{
+    if (key == NULL || key->key_core == NULL || min_time > max_time) return false;
+
+    if (max_time == 0)
+    {
+        key->key_core->key_opts &= (uint8_t)~KEY_OPT_ADAPTIVE_DEBOUNCE;
+        key->key_core->key_debounce.measuring = false;
+        return true;
+    }
+
+    if (key->key_core->key_debounce.mode != KEY_DEBOUNCE_EAGER &&
+        key->key_core->key_debounce.mode != KEY_DEBOUNCE_ASYMMETRIC) return false;
+
+    key->key_tune.adapt_min = KEY_MS_TO_TICK(min_time);
+    key->key_tune.adapt_max = KEY_MS_TO_TICK(max_time);
+    key->key_core->key_debounce.measuring = false;
 
-    // 使用uint16_t，确保不溢出
-    if (debounce_time) key->key_paras.debounce_time = debounce_time;
-    if (long_time) key->key_paras.long_time = long_time;
-    if (long_alws_time) key->key_paras.long_alws_time = long_alws_time;
-    if (multi_time) key->key_paras.multi_time = multi_time;
-    if (multi_max) key->key_multi_paras.multi_max = (multi_max > 15 ? 15 : multi_max); // 4位位域最大值为15
+    // 以当前消抖时间反推抖动估计初值
+    key->key_tune.bounce_est = (key->key_core->key_debounce.press_time << 4) / KEY_DEBOUNCE_MARGIN;
+    key->key_core->key_opts |= KEY_OPT_ADAPTIVE_DEBOUNCE;
+    _NN_Key_TimerArm(key);
 
     return true;
 }
 
+/**
+ * @brief 获取按键当前生效的消抖时间
+ * @param key 按键指针
+ * @return 消抖时间(ms)
+ * @note 自适应消抖模式下返回调优后的值，可保存后通过NN_Key_SetDebounceTime恢复
+ */
+uint16_t NN_Key_GetDebounceTime(nn_key_t *key)
+{
+    uint32_t time_ms;
+
+    if (key == NULL || key->key_core == NULL) return 0;
+
+    time_ms = KEY_TICK_TO_MS(key->key_core->key_debounce.press_time);
+    return (uint16_t)(time_ms > UINT16_MAX ? UINT16_MAX : time_ms);
+}
+
+/**
+ * @brief 获取按键当前手势序号
+ * @param key 按键指针
+ * @return 手势序号
+ * @note 在回调中调用，可将预发单击、撤回事件和最终多击事件关联起来
+ */
+uint8_t NN_Key_GetSeq(nn_key_t *key)
+{
+    if (key == NULL || key->key_core == NULL) return 0;
+
+    return key->key_core->key_seq;
+}
+
+/**
+ * @brief 获取按键在管理列表中的序号
+ * @param key 按键指针
+ * @return 按键序号，未添加时返回-1
+ * @note 序号即NN_Key_PushEdge的index和NN_Key_HandlerBlock端口快照中的位序号；
+ *       O(1)，序号记录在按键的定时器中，删除按键时随搬移同步更新
+ */
+int16_t NN_Key_GetIndex(nn_key_t *key)
+{
+    if (key == NULL || !_NN_Key_Listed(key)) return -1;
+
+    return key->key_timer.index;
+}
+
+/**
+ * @brief 按ID查找按键
+ * @param id 按键ID
+ * @return 按键指针，未找到时返回NULL
+ * @note KEY_ID_HASH_SIZE不为0时通过库内部维护的哈希表查找，平均O(1)；否则逐个比较ID
+ *       有多个同名按键时返回其中之一
+ */
+nn_key_t *NN_Key_Find(const char *id)
+{
+    if (id == NULL) return NULL;
+
+#if KEY_ID_HASH_SIZE > 0
+    int16_t index = _NN_Key_IdFind(_nn_key_id_hash, false, id);
+
+    return (index < 0) ? NULL : _nn_key_list[index];
+#else
+    for (uint8_t i = 0; i < _nn_key_num; i++)
+    {
+        if (_nn_key_list[i]->key_id && strcmp(_nn_key_list[i]->key_id, id) == 0) return _nn_key_list[i];
+    }
+
+    return NULL;
+#endif
+}
+
 /* ========================= 按键回调函数管理 ========================= */
 /**
  * @brief 设置按键回调函数
@@ -132,26 +847,36 @@ bool NN_Key_SetPara(nn_key_t *key,
  * @param user_data 用户数据
  * @return 设置是否成功
  * @note 每种事件类型可以设置独立的回调函数
+ *       使用共享模板的按键会先复制一份私有配置，KEY_PRIVATE_CONFIG为0时需通过模板设置
  */
 bool NN_Key_SetCb(nn_key_t *key, nn_key_event_t event, nn_key_callback_t cb, void *user_data)
 {
+    nn_key_profile_t *own;
+
     // 参数检查
-    if (key == NULL || event >= KEY_EVENT_MAX || cb == NULL) return false;
+    if (key == NULL || key->key_core == NULL || event >= KEY_EVENT_MAX || cb == NULL) return false;
+
+    // 回调表写入私有配置
+    own = _NN_Key_OwnProfile(key);
+    if (own == NULL) return false;
 
     // 设置回调和用户数据
-    key->callbacks[event].func.callback_key = cb;
-    key->callbacks[event].user_data = user_data;
+    own->callbacks[event].func.callback_key = cb;
+    own->callbacks[event].user_data = user_data;
 
     // 设置有回调标志
     if (cb != NULL)
     {
-        key->callback_mask |= (0x01 << event); // 置位对应事件的回调标志位
+        own->callback_mask |= (0x01 << event); // 置位对应事件的回调标志位
     }
     else
     {
-        key->callback_mask &= ~(0x01 << event); // 清除对应事件的回调标志位
+        own->callback_mask &= ~(0x01 << event); // 清除对应事件的回调标志位
     }
 
+    // 持续长按的重复截止时刻取决于是否有回调
+    _NN_Key_TimerArm(key);
+
     return true;
 }
 
@@ -164,17 +889,25 @@ bool NN_Key_SetCb(nn_key_t *key, nn_key_event_t event, nn_key_callback_t cb, voi
  */
 bool NN_Key_DeleteCb(nn_key_t *key, nn_key_event_t event)
 {
+    nn_key_profile_t *own;
+
     // 参数检查
-    if (key == NULL || event >= KEY_EVENT_MAX) return false;
+    if (key == NULL || key->key_core == NULL || event >= KEY_EVENT_MAX) return false;
+
+    // 回调表写入私有配置
+    own = _NN_Key_OwnProfile(key);
+    if (own == NULL) return false;
 
     // 删除回调函数
-    key->callbacks[event].func.callback_key = NULL;
-    key->callbacks[event].user_data = NULL;
-    key->callback_mask &= ~(0x01 << event); // 清除对应事件的回调标志位
+    own->callbacks[event].func.callback_key = NULL;
+    own->callbacks[event].user_data = NULL;
+    own->callback_mask &= ~(0x01 << event); // 清除对应事件的回调标志位
+    _NN_Key_TimerArm(key);
 
     return true;
 }
 
+#if KEY_USE_COMBO
 /* ========================= 组合按键管理 ========================= */
 /**
  * @brief 添加一个组合键
@@ -189,55 +922,25 @@ bool NN_Key_DeleteCb(nn_key_t *key, nn_key_event_t event)
  */
 bool NN_Combo_Add(nn_comb_t *comb, const char *id, uint8_t mem_nbr, nn_key_t *member1, nn_key_t *member2, ...)
 {
-    // 参数检查
-    if (mem_nbr > KEY_MAX_COMBO_MEMBER || _nn_combo_num > KEY_MAX_COMBO_NUMBER) return false;
-    if (comb == NULL || member1 == NULL || member2 == NULL) return false;
-
-    // 初始化组合键基础属性
-    comb->combo_id = id;
-    comb->combo_mem_first = 0;
-    memset(comb->combo_member, 0, sizeof(nn_key_t *) * KEY_MAX_COMBO_MEMBER);
-    comb->combo_window = KEY_COMBO_WINDOW;
-    comb->combo_member_nbr = mem_nbr;
-    comb->combo_value.combo_value_excepted = 0;
-    comb->combo_value.combo_value_now = 0;
-    comb->combo_trigger = false;
-
-    // 设置期望的组合键值掩码
-    for (uint8_t i = 0; i < mem_nbr; i++)
-    {
-        comb->combo_value.combo_value_excepted |= (0x01 << i);
-    }
-
-    // 处理可变参数
+    nn_key_t *members[KEY_MAX_COMBO_MEMBER] = {NULL};
     va_list args;
-    nn_key_t *temp = NULL;
 
-    va_start(args, member2);
+    // 参数检查，成员数下限由_NN_Combo_Setup检查
+    if (mem_nbr > KEY_MAX_COMBO_MEMBER) return false;
 
-    // 将成员添加到列表
-    comb->combo_member[0] = member1;
-    comb->combo_member[1] = member2;
-    member1->key_flags.is_member = true; // 标记为组合键成员
-    member2->key_flags.is_member = true; // 标记为组合键成员
+    // 收集成员
+    members[0] = member1;
+    members[1] = member2;
 
-    // 处理剩余成员
-    for (uint8_t i = 0; i < mem_nbr - 2; i++)
+    va_start(args, member2);
+    for (uint8_t i = 2; i < mem_nbr; i++)
     {
-        temp = va_arg(args, nn_key_t *);
-        if (temp != NULL)
-        {
-            temp->key_flags.is_member = true; // 标记为组合键成员
-            comb->combo_member[2 + i] = temp;
-        }
+        members[i] = va_arg(args, nn_key_t *);
     }
     va_end(args);
 
-    // 添加到组合键列表
-    _nn_combo_list[_nn_combo_num++] = comb;
-
-    return true;
-}
+    return _NN_Combo_Setup(comb, id, mem_nbr, members);
+}
 
 /**
  * @brief 设置组合键的回调函数
@@ -272,18 +975,157 @@ bool NN_Combo_SetWindowTime(nn_comb_t *combo, uint16_t time_ms)
     if (combo == NULL || time_ms > UINT16_MAX) return false;
 
     // 设置窗口时间
-    combo->combo_window = time_ms;
+    combo->combo_window = KEY_MS_TO_TICK(time_ms);
+    _NN_Combo_TimerArm(combo);
+
+    return true;
+}
+
+/**
+ * @brief 从组合键列表中删除组合键
+ * @param comb 组合键的结构体指针
+ * @return 删除是否成功，组合键未添加时返回false
+ * @note 最后一个组合键移到被删除组合键的位置；成员不再属于任何组合键时恢复为普通按键
+ */
+bool NN_Combo_Remove(nn_comb_t *comb)
+{
+    uint8_t index;
+    uint8_t last;
+
+    if (comb == NULL) return false;
+
+    // 定时器序号即组合键在列表中的位置
+    index = comb->combo_timer.index;
+    if (index >= _nn_combo_num || _nn_combo_list[index] != comb) return false;
+
+    _NN_Wheel_Remove(&comb->combo_timer);
+
+    last = (uint8_t)(_nn_combo_num - 1);
+#if KEY_ID_HASH_SIZE > 0
+    _NN_Key_IdErase(_nn_combo_id_hash, true, comb->combo_id, index);
+    if (index != last)
+    {
+        _NN_Key_IdErase(_nn_combo_id_hash, true, _nn_combo_list[last]->combo_id, last);
+        _NN_Key_IdInsert(_nn_combo_id_hash, _nn_combo_list[last]->combo_id, index);
+    }
+#endif
+    if (index != last)
+    {
+        _nn_combo_list[index] = _nn_combo_list[last];
+        _nn_combo_list[index]->combo_timer.index = index;
+    }
+    _nn_combo_list[last] = NULL;
+    _nn_combo_num--;
+
+    // 解除成员标记，仍属于其他组合键的成员重新标记
+    for (uint8_t k = 0; k < comb->combo_member_nbr; k++)
+    {
+        if (comb->combo_member[k] == NULL) continue;
+        comb->combo_member[k]->key_core->key_flags.is_member = false;
+        comb->combo_member[k]->key_core->key_flags.lock_flag = false;
+    }
+    for (uint8_t i = 0; i < _nn_combo_num; i++)
+    {
+        for (uint8_t k = 0; k < _nn_combo_list[i]->combo_member_nbr; k++)
+        {
+            if (_nn_combo_list[i]->combo_member[k]) _nn_combo_list[i]->combo_member[k]->key_core->key_flags.is_member = true;
+        }
+    }
 
     return true;
 }
 
+/**
+ * @brief 按ID查找组合键
+ * @param id 组合键ID
+ * @return 组合键指针，未找到时返回NULL
+ * @note KEY_ID_HASH_SIZE不为0时通过库内部维护的哈希表查找，平均O(1)；否则逐个比较ID
+ */
+nn_comb_t *NN_Combo_Find(const char *id)
+{
+    if (id == NULL) return NULL;
+
+#if KEY_ID_HASH_SIZE > 0
+    int16_t index = _NN_Key_IdFind(_nn_combo_id_hash, true, id);
+
+    return (index < 0) ? NULL : _nn_combo_list[index];
+#else
+    for (uint8_t i = 0; i < _nn_combo_num; i++)
+    {
+        if (_nn_combo_list[i]->combo_id && strcmp(_nn_combo_list[i]->combo_id, id) == 0) return _nn_combo_list[i];
+    }
+
+    return NULL;
+#endif
+}
+
 /* ========================= 组合键内部处理函数 ========================= */
+/**
+ * @brief 初始化组合键并加入组合键列表
+ * @param comb 组合键的结构体指针
+ * @param id 组合键名称
+ * @param mem_nbr 组合键的成员数量
+ * @param members 成员按键数组，前两个成员不能为NULL
+ * @return 是否创建成功，成员数不在2~KEY_MAX_COMBO_MEMBER之间或有成员未添加时返回false
+ * @note 内部函数，由NN_Combo_Add、对象池和静态注册共用
+ */
+static bool _NN_Combo_Setup(nn_comb_t *comb, const char *id, uint8_t mem_nbr, nn_key_t *const *members)
+{
+    // 参数检查
+    if (mem_nbr < 2 || mem_nbr > KEY_MAX_COMBO_MEMBER || _nn_combo_num >= KEY_MAX_COMBO_NUMBER) return false;
+    if (comb == NULL || members == NULL || members[0] == NULL || members[1] == NULL) return false;
+
+    // 成员必须已添加，否则没有运行数据(如静态注册时按键添加失败)
+    for (uint8_t i = 0; i < mem_nbr; i++)
+    {
+        if (members[i] != NULL && !_NN_Key_Listed(members[i])) return false;
+    }
+
+    // 初始化组合键基础属性
+    comb->combo_id = id;
+    comb->combo_mem_first = 0;
+    comb->combo_open = false;
+    memset(&comb->combo_timer, 0, sizeof(comb->combo_timer));
+    comb->combo_timer.index = _nn_combo_num;
+    comb->combo_timer.is_combo = true;
+    memset(comb->combo_member, 0, sizeof(nn_key_t *) * KEY_MAX_COMBO_MEMBER);
+    comb->combo_window = KEY_MS_TO_TICK(KEY_COMBO_WINDOW);
+    comb->combo_member_nbr = mem_nbr;
+    comb->combo_value.combo_value_excepted = 0;
+    comb->combo_value.combo_value_now = 0;
+    comb->combo_trigger = false;
+
+    // 设置期望的组合键值掩码
+    for (uint8_t i = 0; i < mem_nbr; i++)
+    {
+        comb->combo_value.combo_value_excepted |= (0x01 << i);
+    }
+
+    // 将成员添加到列表
+    for (uint8_t i = 0; i < mem_nbr; i++)
+    {
+        if (members[i] != NULL)
+        {
+            members[i]->key_core->key_flags.is_member = true; // 标记为组合键成员
+            comb->combo_member[i] = members[i];
+        }
+    }
+
+    // 添加到组合键列表
+#if KEY_ID_HASH_SIZE > 0
+    _NN_Key_IdInsert(_nn_combo_id_hash, id, _nn_combo_num);
+#endif
+    _nn_combo_list[_nn_combo_num++] = comb;
+
+    return true;
+}
+
 /**
  * @brief 组合键处理函数
- * @param tick 当前系统时钟值(ms)
+ * @param tick 当前系统时钟值(tick)
  * @note 内部函数，处理所有组合键的识别和触发
  */
-static void _NN_Combo_Process(uint32_t tick)
+static void _NN_Combo_Process(nn_key_tick_t tick)
 {
     // 处理所有组合键
     for (uint8_t i = 0; i < _nn_combo_num; i++)
@@ -292,7 +1134,7 @@ static void _NN_Combo_Process(uint32_t tick)
         bool combo_active = false; // 标记组合键是否处于活跃状态
 
         // 如果组合键已经开始形成，标记其成员为锁定状态
-        if (comb->combo_mem_first > 0)
+        if (comb->combo_open)
         {
             combo_active = true;
         }
@@ -303,12 +1145,13 @@ static void _NN_Combo_Process(uint32_t tick)
             nn_key_t *mem_key = comb->combo_member[k];
 
             // 只处理处于PRESSED事件的按键
-            if (mem_key->key_flags.event != KEY_EVENT_PRESSED) continue;
+            if (mem_key->key_core->key_flags.event != KEY_EVENT_PRESSED) continue;
 
-            if (!comb->combo_mem_first)
+            if (!comb->combo_open)
             {
                 // 如果是第一个按下的成员，记录时间戳
                 comb->combo_mem_first = tick;
+                comb->combo_open = true;
                 comb->combo_value.combo_value_now = (1 << k);
                 combo_active = true;
             }
@@ -323,7 +1166,7 @@ static void _NN_Combo_Process(uint32_t tick)
             {
                 comb->combo_trigger = true;
                 comb->combo_value.combo_value_now = 0;
-                comb->combo_mem_first = 0;
+                comb->combo_open = false;
             }
         }
 
@@ -332,7 +1175,7 @@ static void _NN_Combo_Process(uint32_t tick)
         {
             for (uint8_t j = 0; j < comb->combo_member_nbr; j++)
             {
-                comb->combo_member[j]->key_flags.lock_flag = true; // 设置锁定标志
+                comb->combo_member[j]->key_core->key_flags.lock_flag = true; // 设置锁定标志
             }
         }
 
@@ -344,8 +1187,8 @@ static void _NN_Combo_Process(uint32_t tick)
             // 重置所有成员按键事件
             for (uint8_t j = 0; j < comb->combo_member_nbr; j++)
             {
-                comb->combo_member[j]->key_flags.event = KEY_EVENT_INIT;
-                comb->combo_member[j]->key_flags.lock_flag = false; // 解除锁定
+                comb->combo_member[j]->key_core->key_flags.event = KEY_EVENT_INIT;
+                comb->combo_member[j]->key_core->key_flags.lock_flag = false; // 解除锁定
             }
 
             // 触发组合键回调
@@ -356,295 +1199,2792 @@ static void _NN_Combo_Process(uint32_t tick)
         }
 
         // 窗口时间超时处理
-        if (comb->combo_mem_first && tick - comb->combo_mem_first > comb->combo_window)
+        if (comb->combo_open && tick - comb->combo_mem_first > comb->combo_window)
         {
-            comb->combo_mem_first = 0;
+            comb->combo_open = false;
             comb->combo_value.combo_value_now = 0;
 
             // 解除所有成员锁定
             for (uint8_t j = 0; j < comb->combo_member_nbr; j++)
             {
-                comb->combo_member[j]->key_flags.lock_flag = false; // 解除锁定
+                comb->combo_member[j]->key_core->key_flags.lock_flag = false; // 解除锁定
             }
         }
+
+        // 更新窗口超时定时器
+        _NN_Combo_TimerArm(comb);
     }
 }
+#endif
 
-/* ========================= 按键处理主函数 ========================= */
+/* ========================= 配置模板管理 ========================= */
 /**
- * @brief 按键处理函数
- * @param tick 当前系统时钟值(ms)
- * @return 处理是否成功
- * @note 此函数需要由主循环周期性调用，用于刷新所有按键状态和处理事件
- *       建议调用频率不低于10ms一次
+ * @brief 初始化配置模板
+ * @param profile 模板指针
+ * @param id 模板ID
+ * @return 初始化是否成功
+ * @note 设置默认参数并清空回调表；也可直接将模板声明为const并静态初始化，参数需用KEY_MS_TO_TICK换算
  */
-bool NN_Key_Handler(uint32_t tick)
+bool NN_Key_ProfileInit(nn_key_profile_t *profile, const char *id)
 {
-    bool result = true;
+    if (profile == NULL) return false;
 
-    // 首先重置所有组合键成员的锁定状态
-    for (uint8_t i = 0; i < _nn_key_num; i++)
+    profile->profile_id = id;
+    profile->key_paras.debounce_time = KEY_MS_TO_TICK(KEY_DEBOUNCE_TIME); // 消抖时间
+    profile->key_paras.long_time = KEY_MS_TO_TICK(KEY_LONG_PRESS_TIME); // 长按时间
+    profile->key_paras.long_alws_time = KEY_MS_TO_TICK(KEY_LONG_PRESS_ALWS); // 持续长按时间
+    profile->key_paras.multi_time = KEY_MS_TO_TICK(KEY_MULTI_PRESS_TIME); // 连按时间
+    profile->multi_max = 4; // 最大连按次数
+    profile->callback_mask = 0;
+
+    // 初始化所有回调函数指针和用户数据
+    for (uint8_t i = 0; i < KEY_EVENT_MAX; i++)
     {
-        nn_key_t *key = _nn_key_list[i];
-        if (key->key_flags.is_member)
-        {
-            key->key_flags.lock_flag = false; // 重置组合键锁定状态
-        }
+        profile->callbacks[i].func.callback_key = NULL;
+        profile->callbacks[i].user_data = NULL;
     }
 
-    // 更新所有按键的状态
+    return true;
+}
+
+/**
+ * @brief 设置配置模板参数
+ * @param profile 模板指针
+ * @param debounce_time 消抖时间(ms)
+ * @param long_time 长按时间(ms)
+ * @param long_alws_time 持续长按时间(ms)
+ * @param multi_time 连按间隔时间(ms)
+ * @param multi_max 最大连按次数
+ * @return 设置是否成功
+ * @note 传入0表示不修改该参数，修改对所有使用该模板的按键立即生效，
+ *       消抖时间会覆盖这些按键单独设置或自适应调整的值
+ */
+bool NN_Key_ProfileSetPara(nn_key_profile_t *profile,
+                           uint16_t debounce_time,
+                           uint16_t long_time,
+                           uint16_t long_alws_time,
+                           uint16_t multi_time,
+                           uint8_t multi_max)
+{
+    if (profile == NULL) return false;
+
+    if (debounce_time) profile->key_paras.debounce_time = KEY_MS_TO_TICK(debounce_time);
+    if (long_time) profile->key_paras.long_time = KEY_MS_TO_TICK(long_time);
+    if (long_alws_time) profile->key_paras.long_alws_time = KEY_MS_TO_TICK(long_alws_time);
+    if (multi_time) profile->key_paras.multi_time = KEY_MS_TO_TICK(multi_time);
+    if (multi_max) profile->multi_max = (multi_max > 15 ? 15 : multi_max); // 连按计数为4位位域，最大值为15
+
+    // 截止时刻随参数变化，重新安排使用该模板的按键
     for (uint8_t i = 0; i < _nn_key_num; i++)
     {
-        nn_key_t *key = _nn_key_list[i];
-        // 运行按键状态机
-        _NN_Key_StateMachine(key, tick);
+        if (_nn_key_core[i].key_profile != profile) continue;
+
+        if (debounce_time) _nn_key_core[i].key_debounce.press_time = profile->key_paras.debounce_time;
+        _NN_Key_TimerArm(_nn_key_list[i]);
     }
 
-    // 处理组合键
-    _NN_Combo_Process(tick);
+    return true;
+}
+
+/**
+ * @brief 设置配置模板的回调函数
+ * @param profile 模板指针
+ * @param event 事件类型
+ * @param cb 回调函数指针
+ * @param user_data 用户数据
+ * @return 设置是否成功
+ * @note 对所有使用该模板的按键立即生效，回调中可通过key参数区分按键
+ */
+bool NN_Key_ProfileSetCb(nn_key_profile_t *profile, nn_key_event_t event, nn_key_callback_t cb, void *user_data)
+{
+    if (profile == NULL || event >= KEY_EVENT_MAX || cb == NULL) return false;
+
+    profile->callbacks[event].func.callback_key = cb;
+    profile->callbacks[event].user_data = user_data;
+    profile->callback_mask |= (0x01 << event);
 
-    // 处理单个按键事件
+    // 持续长按的重复截止时刻取决于是否有回调
     for (uint8_t i = 0; i < _nn_key_num; i++)
     {
-        nn_key_t *key = _nn_key_list[i];
+        if (_nn_key_core[i].key_profile == profile) _NN_Key_TimerArm(_nn_key_list[i]);
+    }
 
-        // 如果按键被组合键锁定，跳过处理
-        if (key->key_flags.lock_flag)
-        {
-            continue;
-        }
+    return true;
+}
+
+/**
+ * @brief 删除配置模板的回调函数
+ * @param profile 模板指针
+ * @param event 事件类型
+ * @return 删除是否成功
+ */
+bool NN_Key_ProfileDeleteCb(nn_key_profile_t *profile, nn_key_event_t event)
+{
+    if (profile == NULL || event >= KEY_EVENT_MAX) return false;
+
+    profile->callbacks[event].func.callback_key = NULL;
+    profile->callbacks[event].user_data = NULL;
+    profile->callback_mask &= ~(0x01 << event);
 
-        // 处理按键事件
-        result &= _NN_Key_Event(key, tick);
+    for (uint8_t i = 0; i < _nn_key_num; i++)
+    {
+        if (_nn_key_core[i].key_profile == profile) _NN_Key_TimerArm(_nn_key_list[i]);
     }
 
-    return result;
+    return true;
 }
 
-/* ========================= 内部函数实现 ========================= */
 /**
- * @brief 处理按键事件并执行对应回调
+ * @brief 设置按键使用的配置模板
  * @param key 按键指针
- * @param tick 当前系统时钟值(ms)
- * @return 事件是否成功处理
- * @note 内部函数，处理事件的回调触发
+ * @param profile 模板指针，NULL表示恢复使用私有配置
+ * @return 设置是否成功
+ * @note 按键的消抖时间取模板的值，需在NN_Key_Add之后调用
+ *       KEY_PRIVATE_CONFIG为0时NULL表示恢复默认模板
  */
-static bool _NN_Key_Event(nn_key_t *key, uint32_t tick)
+bool NN_Key_SetProfile(nn_key_t *key, const nn_key_profile_t *profile)
 {
-    static uint32_t LastTick = 0; // 静态变量，记录上次长按持续回调的时间
+    if (key == NULL || key->key_core == NULL) return false;
 
-    // 参数检查
-    if (key == NULL) return false;
+    if (profile == NULL)
+    {
+#if KEY_PRIVATE_CONFIG
+        profile = &key->key_own;
+#else
+        profile = &_nn_key_default_profile;
+#endif
+    }
 
-    // 初始化状态不需要处理
-    if (key->key_flags.event == KEY_EVENT_INIT) return true;
+    key->key_core->key_profile = profile;
+    key->key_core->key_debounce.press_time = profile->key_paras.debounce_time;
+    _NN_Key_TimerArm(key);
+
+    return true;
+}
 
-    nn_key_event_t event = (nn_key_event_t)key->key_flags.event;
+/* ========================= 采样分组管理 ========================= */
+/**
+ * @brief 添加采样分组
+ * @param group 分组结构体指针
+ * @param id 分组ID
+ * @param period_ms 采样周期(ms)
+ * @return 添加是否成功，分组已添加时返回false
+ * @note 处理函数每次调用时先判断各分组是否到期，只有到期分组内的按键会被读取和处理，
+ *       适用于拨码开关、门磁等只需低速采样或读取代价较高(如经I2C扩展)的按键
+ */
+bool NN_Key_GroupAdd(nn_key_group_t *group, const char *id, uint16_t period_ms)
+{
+    // 参数检查
+    if (group == NULL || _nn_group_num >= KEY_MAX_GROUP_NUMBER) return false;
 
-    // 检查此事件是否有回调函数
-    if ((key->callback_mask & (0x01 << event)) && key->callbacks[event].func.callback_key != NULL)
+    // 已添加的分组不能重复添加，否则每次调用会被调度两次而不再到期
+    for (uint8_t i = 0; i < _nn_group_num; i++)
     {
-        // 对于持续长按状态，需要持续触发回调
-        if (event == KEY_EVENT_LONG_PRESSED_ALWS)
-        {
-            // 为长按持续状态，每KEY_LONG_PRESS_ALWS_CB毫秒触发一次回调
-            if ((tick - LastTick) >= KEY_LONG_PRESS_ALWS_CB)
-            {
-                LastTick = tick; // 更新上次触发时间
-                key->callbacks[event].func.callback_key(key, event, key->callbacks[event].user_data);
-            }
-            return true;
-        }
+        if (_nn_group_list[i] == group) return false;
+    }
 
-        // 调用回调函数
-        key->callbacks[event].func.callback_key(key, event, key->callbacks[event].user_data);
+    // 初始化分组
+    group->group_id = id;
+    group->group_period = KEY_MS_TO_TICK(period_ms);
+    group->group_next = 0;
+    group->group_started = false;
+    group->group_due = false;
 
-        // 非持续性事件触发一次后重置为初始事件，防止重复触发
-        if (event != KEY_EVENT_LONG_PRESSED_ALWS)
-        {
-            key->key_flags.event = KEY_EVENT_INIT;
-        }
+    // 添加到分组列表
+    _nn_group_list[_nn_group_num++] = group;
 
-        return true;
-    }
+    return true;
+}
 
-    // 没有回调函数但有事件，也重置为初始状态防止重复处理
-    if (key->key_flags.event != KEY_EVENT_LONG_PRESSED_ALWS)
-    {
-        key->key_flags.event = KEY_EVENT_INIT;
-    }
+/**
+ * @brief 修改采样分组的周期
+ * @param group 分组结构体指针
+ * @param period_ms 采样周期(ms)，0表示每次调用都采样
+ * @return 设置是否成功
+ * @note 新周期从下一次采样开始生效
+ */
+bool NN_Key_GroupSetPeriod(nn_key_group_t *group, uint16_t period_ms)
+{
+    // 参数检查
+    if (group == NULL) return false;
+
+    group->group_period = KEY_MS_TO_TICK(period_ms);
 
     return true;
 }
 
 /**
- * @brief 按键状态机处理函数
+ * @brief 设置按键所属的采样分组
  * @param key 按键指针
- * @param tick 当前系统时钟值(ms)
- * @details 该函数实现按键状态转换的核心逻辑，包括:
- *          - 消抖处理
- *          - 短按/长按/持续长按识别
- *          - 多次连击检测
- *          - 各种事件状态的切换与生成
- * @note 内部函数，由NN_Key_Handler调用
+ * @param group 分组结构体指针，NULL表示每次调用都采样(默认)
+ * @return 设置是否成功，分组未通过NN_Key_GroupAdd添加时返回false
+ * @note 未添加的分组不会被调度，其中的按键将永远不再采样
  */
-static void _NN_Key_StateMachine(nn_key_t *key, uint32_t tick)
+bool NN_Key_SetGroup(nn_key_t *key, nn_key_group_t *group)
 {
-    uint32_t now_tick = tick; // 当前系统时钟值
-    uint32_t diff_tick = now_tick - key->key_last_time; // 计算时间差，用于判断按键状态变化时间
-    bool key_val = key->key_read(); // 读取当前按键物理状态（按下为true，释放为false）
+    uint8_t i;
+
+    // 参数检查
+    if (key == NULL) return false;
 
-    // 按键状态机
-    switch (key->key_flags.state)
+    // 只接受已添加的分组
+    for (i = 0; group != NULL && i < _nn_group_num; i++)
     {
-        case KEY_STATE_INIT:
-            // 初始化状态：根据按键初始状态决定下一个状态
-            if (key_val)
-            {
-                // 如果按键被按下，转为PRESSED状态
-                key->key_flags.state = KEY_STATE_PRESSED;
-                key->key_last_time = now_tick; // 更新时间戳
-            }
-            else
-            {
-                // 如果按键未被按下，转为RELEASED状态
-                key->key_flags.state = KEY_STATE_RELEASED;
-                key->key_last_time = now_tick; // 更新时间戳
-                key->key_flags.event = KEY_EVENT_INIT; // 设置初始化事件
-            }
-            break;
+        if (_nn_group_list[i] == group) break;
+    }
+    if (group != NULL && i >= _nn_group_num) return false;
 
-        case KEY_STATE_RELEASED:
-            // 释放状态：检测是否有新的按键按下事件
-            if (key_val && diff_tick >= key->key_paras.debounce_time)
-            {
-                // 检测到按键按下且已超过消抖时间，转为按下状态
-                key->key_flags.state = KEY_STATE_PRESSED;
-                key->key_last_time = now_tick; // 更新时间戳
-                key->key_flags.event = KEY_EVENT_INIT; // 重置事件状态
-            }
-            else if (!key_val)
-            {
-                // 按键持续保持释放状态
-                key->key_flags.state = KEY_STATE_RELEASED;
-            }
-            break;
+    key->key_group = group;
 
-        case KEY_STATE_PRESSED:
-            if (!key_val)
-            {
-                // 按键释放
-                uint32_t press_duration = now_tick - key->key_last_time;
+    return true;
+}
 
-                // 根据按下持续时间判断是短按还是长按
-                if (press_duration >= key->key_paras.long_time)
-                {
-                    // 按下时间超过长按阈值，判定为长按
-                    key->key_flags.event = KEY_EVENT_LONG_PRESSED;
-                    key->key_flags.state = KEY_STATE_RELEASED;
-                    key->key_last_time = now_tick;
-                    key->key_multi_paras.multi_count = 0; // 重置多击计数
-                }
-                else
-                {
-                    // 短按，进入多击检测状态
-                    key->key_flags.state = KEY_STATE_MULTI_PRESSED;
-                    key->key_multi_paras.multi_count++; // 增加点击计数
-                    key->key_last_time = now_tick; // 更新时间戳
-                }
-            }
-            else if (diff_tick >= key->key_paras.long_time && diff_tick < key->key_paras.long_alws_time &&
-                     key->key_paras.long_alws_time > 0)
-            {
-                // 按键持续按下超过长按阈值但尚未达到持续长按阈值
-                // 这个状态用于检测长按后是否进入持续长按状态
-                key->key_flags.state = KEY_STATE_LONG_PRESSED;
-            }
-            else if (diff_tick >= key->key_paras.long_alws_time && key->key_paras.long_alws_time > 0)
-            {
-                // 只有在长按持续时间大于0时才进入持续长按状态
-                // 按键持续按下超过持续长按阈值时间
-                key->key_flags.state = KEY_STATE_LONG_PRESSED_ALWS;
-                key->key_flags.event = KEY_EVENT_LONG_PRESSED_ALWS;
-                key->key_last_time = now_tick; // 更新时间戳
-            }
-            break;
+/* ========================= 按键处理主函数 ========================= */
+/**
+ * @brief 按键处理函数
+ * @param tick 当前系统时钟值(tick)
+ * @return 处理是否成功
+ * @note 此函数需要由主循环周期性调用，用于刷新所有按键状态和处理事件
+ *       建议调用频率不低于10ms一次
+ */
+bool NN_Key_Handler(nn_key_tick_t tick)
+{
+    bool result = true;
 
-        case KEY_STATE_LONG_PRESSED:
-            // 长按状态，如果释放则触发长按事件
-            if (!key_val)
-            {
-                key->key_flags.event = KEY_EVENT_LONG_PRESSED;
-                key->key_flags.state = KEY_STATE_RELEASED;
-                key->key_last_time = now_tick; // 更新时间戳
-                key->key_multi_paras.multi_count = 0; // 重置多击计数
-            }
-            else if (diff_tick >= key->key_paras.long_alws_time && key->key_paras.long_alws_time > 0)
-            {
-                // 长按状态下继续按住达到持续长按阈值，转入持续长按状态
-                key->key_flags.state = KEY_STATE_LONG_PRESSED_ALWS;
-                key->key_flags.event = KEY_EVENT_LONG_PRESSED_ALWS;
-                key->key_last_time = now_tick; // 更新时间戳
-            }
-            break;
+#if KEY_USE_SECTION
+    // 首次调用时添加静态注册的按键和组合键
+    if (!_nn_key_reg_done) NN_Key_RegisterAll();
+#endif
 
-        case KEY_STATE_LONG_PRESSED_ALWS:
-            if (!key_val)
-            {
-                // 持续长按后按键被释放
-                key->key_last_time = now_tick; // 更新时间戳
-                key->key_flags.state = KEY_STATE_RELEASED; // 回到释放状态
-                key->key_flags.event = KEY_EVENT_INIT; // 重置事件为初始状态，确保不会继续触发
-                key->key_multi_paras.multi_count = 0; // 重置多击计数
-            }
-            else
-            {
-                // 按键仍然保持按下，持续触发持续长按事件
-                key->key_flags.event = KEY_EVENT_LONG_PRESSED_ALWS; // 持续产生长按事件
-            }
-            break;
+    // 先按时间顺序处理中断记录的边沿
+    result &= _NN_Key_EdgeDrain(tick);
 
-        case KEY_STATE_MULTI_PRESSED:
-            if (key_val && diff_tick >= key->key_paras.debounce_time)
-            {
-                // 在多击等待期间检测到新的按下
-                key->key_flags.state = KEY_STATE_PRESSED; // 回到按下状态
-                key->key_last_time = now_tick; // 更新时间戳
-            }
-            else if (!key_val && diff_tick >= key->key_paras.multi_time)
-            {
-                // 超过多击等待时间，多击序列结束
+    // 统计调用间隔
+    _NN_Key_JitterRecord(tick);
 
-                // 根据累计的点击次数设置对应的事件类型
-                if (key->key_multi_paras.multi_count == 1)
-                {
-                    key->key_flags.event = KEY_EVENT_PRESSED; // 单击
-                }
-                else if (key->key_multi_paras.multi_count == 2)
-                {
-                    key->key_flags.event = KEY_EVENT_DOUBLE_PRESSED; // 双击
-                }
-                else if (key->key_multi_paras.multi_count == 3)
-                {
-                    key->key_flags.event = KEY_EVENT_TRIPLE_PRESSED; // 三击
-                }
-                else if (key->key_multi_paras.multi_count > 3)
-                {
-                    key->key_flags.event = KEY_EVENT_MULTI_PRESSED; // 多击（超过三次）
-                }
+    // 时间轮为空时对齐到当前时刻，避免长时间空闲后时刻差溢出
+    if (_nn_wheel_count == 0) _nn_wheel_base = tick;
 
-                key->key_flags.state = KEY_STATE_RELEASED; // 回到释放状态
-                key->key_last_time = now_tick; // 更新时间戳
-                key->key_multi_paras.multi_count = 0; // 重置多击计数器
+    // 调用间隔过长(休眠唤醒、阻塞操作)或开启抖动补偿时，先按实际时刻结算间隔内到期的超时
+    if ((_nn_key_catchup_gap && tick - _nn_key_last_tick >= _nn_key_catchup_gap) ||
+        (_nn_key_jitter_comp && tick != _nn_key_last_tick))
+    {
+        result &= NN_Key_CatchUp(tick);
+    }
+
+    // 判断各采样分组本次是否到期
+    for (uint8_t i = 0; i < _nn_group_num; i++)
+    {
+        _NN_Key_GroupSchedule(_nn_group_list[i], tick);
+    }
+
+    // 读取并更新所有按键的状态
+    for (uint8_t i = 0; i < _nn_key_num; i++)
+    {
+        nn_key_t *key = _nn_key_list[i];
+
+        // 所属分组未到期的按键本次不采样
+        if (key->key_group && !key->key_group->group_due) continue;
+
+        _NN_Key_Poll(i, tick);
+    }
+
+    // 处理组合键和按键事件
+    result &= _NN_Key_Dispatch(tick);
+
+    // 所有按键都已在tick运行过状态机，整理到期的定时器
+    _NN_Key_TimerSettle(tick, false);
+
+    return result;
+}
+
+/**
+ * @brief 按键处理函数(自适应调用间隔)
+ * @param tick 当前系统时钟值(tick)
+ * @param idle 输出所有按键是否空闲，可为NULL
+ * @return 建议的下次调用间隔(tick)
+ * @note 与NN_Key_Handler相同，处理完成后按当前按键状态给出建议的调用间隔，见NN_Key_PollInterval
+ */
+nn_key_span_t NN_Key_HandlerAdaptive(nn_key_tick_t tick, bool *idle)
+{
+    NN_Key_Handler(tick);
+
+    return NN_Key_PollInterval(tick, idle);
+}
+
+/**
+ * @brief 计算建议的下次调用间隔
+ * @param tick 当前系统时钟值(tick)
+ * @param idle 输出所有按键是否空闲，可为NULL
+ * @return 建议的下次调用间隔(tick)
+ * @note 有按键处于手势中(消抖、按下、连按窗口)、组合键窗口打开或有未处理的边沿时为KEY_POLL_ACTIVE_MS，
+ *       全部空闲时为KEY_POLL_IDLE_MS，两者都不超过最近的截止时刻和分组采样时刻
+ *       idle为true时，调用者若要停止轮询或休眠超过建议间隔，需开启按键的边沿唤醒，
+ *       唤醒后调用处理函数即可退出空闲
+ */
+nn_key_span_t NN_Key_PollInterval(nn_key_tick_t tick, bool *idle)
+{
+    bool all_idle = (_nn_key_edge_tail == _nn_key_edge_head);
+    bool parked = false;
+    nn_key_tick_t when;
+    nn_key_tick_t deadline;
+
+    // 判断是否所有按键和组合键都已空闲
+    for (uint8_t w = 0; w * 32 < _nn_key_num && all_idle; w++)
+    {
+        uint8_t base = (uint8_t)(w * 32);
+        uint32_t valid = (_nn_key_num - base >= 32) ? 0xFFFFFFFFUL : ((1UL << (_nn_key_num - base)) - 1);
+
+        if ((_nn_key_idle_mask[w] & valid) != valid) all_idle = false;
+    }
+
+    // 限额处理挂起的按键截止时刻已过
+    for (uint8_t w = 0; w * 32 < _nn_key_num; w++)
+    {
+        if (_nn_key_parked[w]) parked = true;
+    }
+
+#if KEY_USE_COMBO
+    for (uint8_t i = 0; i < _nn_combo_num && all_idle; i++)
+    {
+        if (_nn_combo_list[i]->combo_open) all_idle = false;
+    }
+#endif
+
+    when = tick + (all_idle ? KEY_MS_TO_TICK(KEY_POLL_IDLE_MS) : KEY_MS_TO_TICK(KEY_POLL_ACTIVE_MS));
+
+    // 不晚于最近的截止时刻
+    if (_NN_Wheel_Peek(&deadline) && KEY_TICK_BEFORE(deadline, when))
+    {
+        when = deadline;
+    }
+
+    // 不晚于最近的分组采样时刻
+    for (uint8_t i = 0; i < _nn_group_num; i++)
+    {
+        if (_nn_group_list[i]->group_started && KEY_TICK_BEFORE(_nn_group_list[i]->group_next, when))
+        {
+            when = _nn_group_list[i]->group_next;
+        }
+    }
+
+    if (idle != NULL) *idle = all_idle;
+
+    // 截止时刻已过或有挂起的按键时尽快调用
+    if (parked || !KEY_TICK_BEFORE(tick, when)) return 1;
+
+    return (nn_key_span_t)(when - tick);
+}
+
+/**
+ * @brief 按键处理函数(限额轮转)
+ * @param tick 当前系统时钟值(tick)
+ * @param budget 本次最多读取并处理的按键数
+ * @return 处理是否成功，budget小于NN_Key_GetBudgetLeast()时也返回false
+ * @note 适用于每个周期只有固定处理时间的控制循环，从上次停下的按键开始轮转处理，
+ *       每次调用读取的按键数不超过budget，每个按键至少每ceil(按键数/budget)次调用被处理一次
+ *       budget不足以满足NN_Key_SetBudgetLatency设置的间隔时仍只处理budget个按键并返回false，
+ *       由调用者决定是否增大budget
+ *       只运行轮到的按键的状态机，事件分发只涉及本次处理过的按键和组合键成员
+ *       不区分采样分组；未轮到的按键截止时刻到达后挂起，在下次轮到时结算
+ */
+bool NN_Key_HandlerBudget(nn_key_tick_t tick, uint8_t budget)
+{
+    bool result = true;
+
+#if KEY_USE_SECTION
+    // 首次调用时添加静态注册的按键和组合键
+    if (!_nn_key_reg_done) NN_Key_RegisterAll();
+#endif
+
+    // 先按时间顺序处理中断记录的边沿
+    result &= _NN_Key_EdgeDrain(tick);
+
+    // 统计调用间隔
+    _NN_Key_JitterRecord(tick);
+
+    // 时间轮为空时对齐到当前时刻，避免长时间空闲后时刻差溢出
+    if (_nn_wheel_count == 0) _nn_wheel_base = tick;
+
+    // 调用间隔过长或开启抖动补偿时，先按实际时刻结算间隔内到期的超时
+    if ((_nn_key_catchup_gap && tick - _nn_key_last_tick >= _nn_key_catchup_gap) ||
+        (_nn_key_jitter_comp && tick != _nn_key_last_tick))
+    {
+        result &= NN_Key_CatchUp(tick);
+    }
+
+    // 限额不足以保证最大处理间隔时报告给调用者，不擅自超支
+    if (budget < NN_Key_GetBudgetLeast()) result = false;
+    if (budget > _nn_key_num) budget = _nn_key_num;
+
+    // 从上次停下的位置轮转处理
+    for (uint8_t n = 0; n < budget; n++)
+    {
+        if (_nn_key_rr_next >= _nn_key_num) _nn_key_rr_next = 0;
+
+        _NN_Key_Poll(_nn_key_rr_next, tick);
+        _nn_key_rr_next++;
+    }
+
+    // 处理组合键和按键事件
+    result &= _NN_Key_Dispatch(tick);
+
+    // 整理到期的定时器，未轮到的按键挂起到轮到时再结算
+    _NN_Key_TimerSettle(tick, true);
+
+    return result;
+}
+
+/**
+ * @brief 设置限额处理的最大处理间隔
+ * @param calls 每个按键至少每多少次NN_Key_HandlerBudget调用被处理一次，0为不限制
+ * @return 设置是否成功
+ * @note 不改变NN_Key_HandlerBudget处理的按键数，只用于检查传入的budget是否足够，
+ *       按键数增加后可用NN_Key_GetBudgetLeast重新获取所需的最少按键数
+ */
+bool NN_Key_SetBudgetLatency(uint8_t calls)
+{
+    _nn_key_rr_calls = calls;
+
+    return true;
+}
+
+/**
+ * @brief 获取满足最大处理间隔所需的最少限额
+ * @return 每次NN_Key_HandlerBudget调用至少需处理的按键数，未设置最大处理间隔时为0
+ */
+uint8_t NN_Key_GetBudgetLeast(void)
+{
+    if (_nn_key_rr_calls == 0) return 0;
+
+    return (uint8_t)((_nn_key_num + _nn_key_rr_calls - 1) / _nn_key_rr_calls);
+}
+
+/**
+ * @brief 按键块处理函数
+ * @param ports 端口快照数组，每个采样占KEY_PORT_WORDS个字，第i位为第i个添加的按键电平(1: 按下)
+ * @param ticks 每个采样的时间戳数组(tick)，需单调递增
+ * @param count 采样数
+ * @return 处理是否成功
+ * @note 用于DMA等方式批量采集的高速采样，一次调用处理整块数据，
+ *       等价于对每个采样依次调用NN_Key_Handler，但不调用按键读取函数
+ *       按字并行比较电平变化，电平未变且没有到期截止时刻的按键直接跳过，全部空闲时整个采样只需几次字比较
+ */
+bool NN_Key_HandlerBlock(const uint32_t *ports, const nn_key_tick_t *ticks, uint16_t count)
+{
+    bool result = true;
+
+    if (ports == NULL || ticks == NULL) return false;
+
+    for (uint16_t n = 0; n < count; n++, ports += KEY_PORT_WORDS)
+    {
+        result &= _NN_Key_Sample(ports, ticks[n]);
+    }
+
+    return result;
+}
+
+/**
+ * @brief 按键处理函数(变化掩码)
+ * @param tick 当前系统时钟值(tick)
+ * @param dirty 可能发生变化的按键位图，占KEY_PORT_WORDS个字，第i位对应第i个添加的按键
+ * @return 处理是否成功
+ * @note 适用于GPIO控制器能锁存引脚变化标志的场合，由调用者读取并清除硬件标志后传入
+ *       只调用标记按键的读取函数，未标记的按键视为电平不变，
+ *       仅在截止时刻到达(或积分/移位消抖尚未稳定)时以上次的电平运行状态机
+ *       不区分采样分组，标记的按键总会被读取
+ */
+bool NN_Key_HandlerMask(nn_key_tick_t tick, const uint32_t *dirty)
+{
+    bool result = true;
+    uint32_t ports[KEY_PORT_WORDS];
+
+    if (dirty == NULL) return false;
+
+#if KEY_USE_SECTION
+    // 首次调用时添加静态注册的按键和组合键
+    if (!_nn_key_reg_done) NN_Key_RegisterAll();
+#endif
+
+    // 先按时间顺序处理中断记录的边沿
+    result &= _NN_Key_EdgeDrain(tick);
+
+    // 统计调用间隔
+    _NN_Key_JitterRecord(tick);
+
+    // 调用间隔过长或开启抖动补偿时，先按实际时刻结算间隔内到期的超时
+    if ((_nn_key_catchup_gap && tick - _nn_key_last_tick >= _nn_key_catchup_gap) ||
+        (_nn_key_jitter_comp && tick != _nn_key_last_tick))
+    {
+        result &= NN_Key_CatchUp(tick);
+    }
+
+    // 只读取被标记的按键，其余沿用上次的电平
+    memcpy(ports, _nn_key_port_last, sizeof(ports));
+    for (uint8_t w = 0; w * 32 < _nn_key_num; w++)
+    {
+        uint32_t mark = dirty[w];
+
+        while (mark)
+        {
+            uint8_t bit = 0;
+            uint8_t i;
+
+            while (!(mark & (1UL << bit))) bit++;
+            mark &= mark - 1; // 清除最低位
+
+            i = (uint8_t)(w * 32 + bit);
+            if (i >= _nn_key_num) break;
+
+            // 边沿驱动的按键电平已由边沿更新
+            if (_nn_key_core[i].key_opts & KEY_OPT_EDGE_SOURCE) continue;
+
+            if (_nn_key_list[i]->key_read())
+            {
+                ports[w] |= (1UL << bit);
+            }
+            else
+            {
+                ports[w] &= ~(1UL << bit);
+            }
+        }
+    }
+
+    result &= _NN_Key_Sample(ports, tick);
+
+    return result;
+}
+
+/**
+ * @brief 采样阶段: 读取所有按键电平
+ * @param tick 当前系统时钟值(tick)
+ * @return 是否记录成功，当前半区已满时返回false
+ * @note 供定时器中断周期性调用，只读取电平写入双缓冲区的一个半区，不运行状态机也不调用回调，
+ *       耗时只与按键数量有关；处理阶段空闲时将写满的半区交给NN_Key_Process，自身切换到另一半区
+ *       边沿驱动的按键不读取，其电平由处理阶段从边沿获得
+ *       不区分采样分组，所有按键每次都会被读取
+ */
+bool NN_Key_SampleISR(nn_key_tick_t tick)
+{
+    uint8_t half = _nn_key_sbuf_write;
+    uint16_t n = _nn_key_sbuf_count[half];
+    uint32_t *port;
+
+    // 处理阶段来不及消费，本次采样丢弃
+    if (n >= KEY_SAMPLE_BUF_SIZE) return false;
+
+    port = _nn_key_sbuf_port[half][n];
+    for (uint8_t w = 0; w < KEY_PORT_WORDS; w++) port[w] = 0;
+
+    for (uint8_t i = 0; i < _nn_key_num; i++)
+    {
+        nn_key_t *key = _nn_key_list[i];
+
+        if (key->key_core->key_opts & KEY_OPT_EDGE_SOURCE) continue;
+
+        if (key->key_read()) port[i >> 5] |= (1UL << (i & 31));
+    }
+    _nn_key_sbuf_tick[half][n] = tick;
+    _nn_key_sbuf_count[half] = (uint16_t)(n + 1);
+
+    // 另一半区已处理完时交换，先清空再发布
+    if (!_nn_key_sbuf_ready)
+    {
+        _nn_key_sbuf_count[half ^ 1] = 0;
+        _nn_key_sbuf_write = (uint8_t)(half ^ 1);
+        _nn_key_sbuf_ready = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 处理阶段: 处理采样阶段交来的半区
+ * @return 处理是否成功
+ * @note 在主循环或线程中调用，按时间戳依次运行状态机并分发事件，中断记录的边沿按时间插入其间，
+ *       效果与NN_Key_HandlerBlock相同；没有交来的数据时立即返回
+ *       处理和回调的耗时不影响采样的周期性，但所有采样都需在半区写满前被处理
+ */
+bool NN_Key_Process(void)
+{
+    bool result = true;
+    uint8_t half;
+    uint16_t count;
+    uint32_t edge_mask[KEY_PORT_WORDS] = {0};
+
+    if (!_nn_key_sbuf_ready) return true;
+
+    half = (uint8_t)(_nn_key_sbuf_write ^ 1);
+    count = _nn_key_sbuf_count[half];
+
+    // 边沿驱动的按键沿用边沿给出的电平
+    for (uint8_t i = 0; i < _nn_key_num; i++)
+    {
+        if (_nn_key_core[i].key_opts & KEY_OPT_EDGE_SOURCE) edge_mask[i >> 5] |= (1UL << (i & 31));
+    }
+
+    for (uint16_t n = 0; n < count; n++)
+    {
+        uint32_t *port = _nn_key_sbuf_port[half][n];
+
+        // 先处理不晚于该采样的边沿
+        result &= _NN_Key_EdgeDrain(_nn_key_sbuf_tick[half][n]);
+
+        for (uint8_t w = 0; w < KEY_PORT_WORDS; w++)
+        {
+            port[w] = (port[w] & ~edge_mask[w]) | (_nn_key_port_last[w] & edge_mask[w]);
+        }
+        result &= _NN_Key_Sample(port, _nn_key_sbuf_tick[half][n]);
+    }
+
+    // 交还半区，采样阶段下次可以交换
+    _nn_key_sbuf_ready = false;
+
+    return result;
+}
+
+/**
+ * @brief 记录一个按键边沿
+ * @param index 按键序号(见NN_Key_GetIndex)
+ * @param level 边沿后的电平(按下为true)
+ * @param tick 边沿发生时的系统时钟值(tick)
+ * @return 是否记录成功，缓冲区满时返回false
+ * @note 供GPIO/EXTI中断调用，无锁单生产者单消费者环形缓冲区，
+ *       多个调用本函数的中断之间不能相互抢占(设为相同优先级)
+ *       按键需开启KEY_OPT_EDGE_SOURCE，处理函数将使用边沿的精确时间戳
+ */
+bool NN_Key_PushEdge(uint8_t index, bool level, nn_key_tick_t tick)
+{
+    uint16_t head = _nn_key_edge_head;
+
+    // 缓冲区满
+    if ((uint16_t)(head - _nn_key_edge_tail) >= KEY_EDGE_FIFO_SIZE) return false;
+
+    // 先写数据，再发布写位置
+    _nn_key_edge_fifo[head & (KEY_EDGE_FIFO_SIZE - 1)].tick = tick;
+    _nn_key_edge_fifo[head & (KEY_EDGE_FIFO_SIZE - 1)].index = index;
+    _nn_key_edge_fifo[head & (KEY_EDGE_FIFO_SIZE - 1)].level = level;
+    _nn_key_edge_head = (uint16_t)(head + 1);
+
+    return true;
+}
+
+/**
+ * @brief 追赶结算到指定时刻
+ * @param tick 当前系统时钟值(tick)
+ * @return 事件是否全部成功处理
+ * @note 不读取按键，假定各按键保持最近一次采样的电平，
+ *       按时间顺序找出所有早于tick的截止时刻(消抖、长按、持续长按及其回调间隔、连按窗口、组合键窗口)，
+ *       逐个在截止时刻运行状态机并分发事件，结果与期间持续轮询一致
+ *       适用于深度休眠唤醒、擦写Flash等长时间未调用处理函数的场合，之后再调用NN_Key_Handler采样
+ *       积分/移位消抖按采样次数计数，追赶期间不推进
+ */
+bool NN_Key_CatchUp(nn_key_tick_t tick)
+{
+    bool result = true;
+
+    for (uint16_t n = 0; n < KEY_CATCHUP_MAX_STEPS; n++)
+    {
+        nn_key_tick_t when;
+        nn_key_tick_t deadline;
+        nn_key_timer_t *timer;
+        nn_key_timer_t *following;
+
+        // 从时间轮取出最早的截止时刻，不早于tick的交给正常采样处理
+        if (!_NN_Wheel_Next(tick - 1, &when)) break;
+
+        // 截止时刻不会早于上一次处理的时刻
+        if (KEY_TICK_BEFORE(when, _nn_key_last_tick)) when = _nn_key_last_tick;
+
+        // 在截止时刻运行所有到期按键的状态机，组合键窗口在分发时处理
+        for (timer = _NN_Wheel_Pop(); timer != NULL; timer = following)
+        {
+            nn_key_t *key;
+
+            following = timer->next; // 运行状态机后可能重新放入时间轮
+            if (timer->is_combo) continue;
+
+            key = _nn_key_list[timer->index];
+            if (_NN_Key_NextDeadline(key, &deadline) && !KEY_TICK_BEFORE(when, deadline))
+            {
+                _NN_Key_StateMachine(key, when, key->key_core->key_debounce.raw);
+            }
+            else
+            {
+                _NN_Key_TimerArm(key);
+            }
+        }
+
+        result &= _NN_Key_Dispatch(when);
+    }
+
+    return result;
+}
+
+/**
+ * @brief 设置自动追赶的间隔阈值
+ * @param gap_ms 间隔阈值(ms)，0为关闭(默认)
+ * @return 设置是否成功
+ * @note 开启后，NN_Key_Handler距上次调用超过该间隔时会先调用NN_Key_CatchUp
+ *       存在边沿驱动的按键时，处理函数每次都会先追赶到当前时刻，与该阈值无关
+ */
+bool NN_Key_SetCatchUpGap(uint16_t gap_ms)
+{
+    _nn_key_catchup_gap = KEY_MS_TO_TICK(gap_ms);
+
+    return true;
+}
+
+/**
+ * @brief 获取处理函数调用间隔统计
+ * @param stat 输出统计结果
+ * @return 获取是否成功
+ * @note 间隔由NN_Key_Handler的相邻两次调用计算，单位为tick
+ */
+bool NN_Key_GetJitter(nn_key_jitter_t *stat)
+{
+    // 参数检查
+    if (stat == NULL) return false;
+
+    *stat = _nn_key_jitter;
+
+    return true;
+}
+
+/**
+ * @brief 获取处理函数调用间隔的百分位数
+ * @param percent 百分位(1~100)
+ * @return 不超过该百分位的间隔上界(tick)，无统计数据时返回0
+ * @note 精度为直方图桶宽，结果不超过实测最长间隔
+ */
+nn_key_span_t NN_Key_GetJitterPercentile(uint8_t percent)
+{
+    nn_key_span_t width = KEY_MS_TO_TICK(KEY_JITTER_BUCKET_MS);
+    uint32_t target;
+    uint32_t sum = 0;
+
+    // 参数检查
+    if (percent == 0 || percent > 100 || _nn_key_jitter.count == 0) return 0;
+
+    // 落在该百分位的间隔序号(向上取整)
+    target = (uint32_t)(((uint64_t)_nn_key_jitter.count * percent + 99) / 100);
+
+    for (uint8_t i = 0; i < KEY_JITTER_BUCKETS - 1; i++)
+    {
+        sum += _nn_key_jitter_hist[i];
+        if (sum >= target)
+        {
+            nn_key_span_t upper = width * (i + 1);
+            return upper < _nn_key_jitter.max ? upper : _nn_key_jitter.max;
+        }
+    }
+
+    // 落在溢出桶，只能以最长间隔作为上界
+    return _nn_key_jitter.max;
+}
+
+/**
+ * @brief 清空处理函数调用间隔统计
+ * @return 清空是否成功
+ */
+bool NN_Key_ResetJitter(void)
+{
+    memset(_nn_key_jitter_hist, 0, sizeof(_nn_key_jitter_hist));
+    memset(&_nn_key_jitter, 0, sizeof(_nn_key_jitter));
+    _nn_key_poll_valid = false;
+
+    return true;
+}
+
+/**
+ * @brief 开启或关闭调用抖动补偿
+ * @param enable 是否开启
+ * @return 设置是否成功
+ * @note 开启后，NN_Key_Handler每次调用都先按实际经过的时间结算到期的超时，
+ *       调用迟到时长按、连按窗口等判定仍在其真实截止时刻生效
+ */
+bool NN_Key_SetJitterComp(bool enable)
+{
+    _nn_key_jitter_comp = enable;
+
+    return true;
+}
+
+/* ========================= ID索引 ========================= */
+/**
+ * @brief 计算ID的哈希值(FNV-1a)
+ * @param id ID字符串
+ * @return 32位哈希值
+ */
+static uint32_t _NN_Key_IdHash(const char *id)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (*id)
+    {
+        hash ^= (uint8_t)*id++;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+#if KEY_ID_HASH_SIZE > 0
+/**
+ * @brief 取列表中指定序号的ID
+ * @param is_combo 是否为组合键列表
+ * @param index 序号
+ * @return ID字符串
+ */
+static const char *_NN_Key_IdOf(bool is_combo, uint8_t index)
+{
+#if KEY_USE_COMBO
+    if (is_combo) return _nn_combo_list[index]->combo_id;
+#else
+    (void)is_combo;
+#endif
+
+    return _nn_key_list[index]->key_id;
+}
+
+/**
+ * @brief 将ID加入哈希表
+ * @param table 哈希表
+ * @param id ID字符串，为NULL时不加入
+ * @param index ID所属的列表序号
+ */
+static void _NN_Key_IdInsert(uint8_t *table, const char *id, uint8_t index)
+{
+    uint32_t slot;
+
+    if (id == NULL) return;
+
+    // 槽数大于列表容量，总能找到空槽
+    slot = _NN_Key_IdHash(id) & (KEY_ID_HASH_SIZE - 1);
+    while (table[slot] != 0)
+    {
+        slot = (slot + 1) & (KEY_ID_HASH_SIZE - 1);
+    }
+    table[slot] = (uint8_t)(index + 1);
+}
+
+/**
+ * @brief 从哈希表中删除ID
+ * @param table 哈希表
+ * @param is_combo 是否为组合键列表
+ * @param id 加入时的ID字符串
+ * @param index ID所属的列表序号
+ * @note 删除后将探测链上的后续项前移，不留删除标记，查找性能不随增删退化
+ */
+static void _NN_Key_IdErase(uint8_t *table, bool is_combo, const char *id, uint8_t index)
+{
+    uint32_t hole;
+    uint32_t next;
+
+    if (id == NULL) return;
+
+    // 找到该序号所在的槽
+    hole = _NN_Key_IdHash(id) & (KEY_ID_HASH_SIZE - 1);
+    while (table[hole] != (uint8_t)(index + 1))
+    {
+        if (table[hole] == 0) return;
+        hole = (hole + 1) & (KEY_ID_HASH_SIZE - 1);
+    }
+
+    // 起始槽不在空槽与当前槽之间的项可以前移到空槽
+    next = hole;
+    for (;;)
+    {
+        uint32_t home;
+
+        next = (next + 1) & (KEY_ID_HASH_SIZE - 1);
+        if (table[next] == 0) break;
+
+        home = _NN_Key_IdHash(_NN_Key_IdOf(is_combo, table[next] - 1)) & (KEY_ID_HASH_SIZE - 1);
+        if (((next - home) & (KEY_ID_HASH_SIZE - 1)) >= ((next - hole) & (KEY_ID_HASH_SIZE - 1)))
+        {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+    table[hole] = 0;
+}
+
+/**
+ * @brief 在哈希表中查找ID
+ * @param table 哈希表
+ * @param is_combo 是否为组合键列表
+ * @param id ID字符串
+ * @return 列表序号，未找到时返回-1
+ */
+static int16_t _NN_Key_IdFind(const uint8_t *table, bool is_combo, const char *id)
+{
+    uint32_t slot = _NN_Key_IdHash(id) & (KEY_ID_HASH_SIZE - 1);
+
+    while (table[slot] != 0)
+    {
+        uint8_t index = table[slot] - 1;
+
+        if (strcmp(_NN_Key_IdOf(is_combo, index), id) == 0) return index;
+        slot = (slot + 1) & (KEY_ID_HASH_SIZE - 1);
+    }
+
+    return -1;
+}
+#endif
+
+/**
+ * @brief 由哈希值和扰动值计算完美哈希位置
+ * @param hash ID的哈希值
+ * @param disp 所在桶的扰动值
+ * @param count 表项数
+ * @return 哈希位置
+ */
+static uint8_t _NN_Key_PhashSlot(uint32_t hash, uint16_t disp, uint8_t count)
+{
+    hash ^= disp * 0x9E3779B9UL;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+
+    return (uint8_t)(hash % count);
+}
+
+/**
+ * @brief 为按键描述表生成最小完美哈希索引
+ * @param ph 完美哈希索引
+ * @param keys 与描述表一一对应的按键数组
+ * @param table 按键描述表，ID不能为NULL或重复
+ * @param count 表项数
+ * @param disp 扰动值数组，项数为KEY_PHASH_BUCKETS(count)
+ * @param slot 映射数组，项数为count
+ * @return 生成是否成功，ID为NULL、重复或哈希值相同时返回false
+ * @note 每两个表项一个桶，先为成员多的桶寻找使其全部落入空位置的扰动值，
+ *       生成只需执行一次，之后查找只需计算一次哈希并比较一次ID
+ */
+bool NN_Key_PhashBuild(nn_key_phash_t *ph, nn_key_t *keys, const nn_key_desc_t *table, uint8_t count, uint16_t *disp, uint8_t *slot)
+{
+    uint8_t buckets = KEY_PHASH_BUCKETS(count);
+    uint8_t members[KEY_PHASH_MAX_BUCKET];
+    uint32_t hashes[KEY_PHASH_MAX_BUCKET];
+
+    if (ph == NULL || keys == NULL || table == NULL || disp == NULL || slot == NULL || count == 0) return false;
+
+    // 先统计各桶的成员数，最高位标记为未处理
+    memset(disp, 0, buckets * sizeof(uint16_t));
+    memset(slot, 0xFF, count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (table[i].key_id == NULL) return false;
+        disp[_NN_Key_IdHash(table[i].key_id) % buckets]++;
+    }
+    for (uint8_t b = 0; b < buckets; b++)
+    {
+        if (disp[b] > KEY_PHASH_MAX_BUCKET) return false;
+        if (disp[b] > 0) disp[b] |= 0x8000;
+    }
+
+    // 成员多的桶可选位置多，先处理
+    for (uint8_t size = KEY_PHASH_MAX_BUCKET; size > 0; size--)
+    {
+        for (uint8_t b = 0; b < buckets; b++)
+        {
+            uint8_t n = 0;
+            uint16_t d;
+
+            if (disp[b] != (0x8000 | size)) continue;
+
+            for (uint8_t i = 0; i < count; i++)
+            {
+                uint32_t hash = _NN_Key_IdHash(table[i].key_id);
+
+                if (hash % buckets != b) continue;
+                members[n] = i;
+                hashes[n++] = hash;
+            }
+
+            // 寻找使桶内成员全部落入不同空位置的扰动值
+            for (d = 0; d < 0x8000; d++)
+            {
+                uint8_t k;
+
+                for (k = 0; k < n; k++)
+                {
+                    uint8_t pos = _NN_Key_PhashSlot(hashes[k], d, count);
+
+                    if (slot[pos] != 0xFF) break;
+                    slot[pos] = members[k];
+                }
+                if (k == n) break;
+
+                // 冲突，撤销本次放置
+                while (k-- > 0)
+                {
+                    slot[_NN_Key_PhashSlot(hashes[k], d, count)] = 0xFF;
+                }
+            }
+            if (d == 0x8000) return false;
+
+            disp[b] = d;
+        }
+    }
+
+    ph->table = table;
+    ph->keys = keys;
+    ph->disp = disp;
+    ph->slot = slot;
+    ph->count = count;
+
+    return true;
+}
+
+/**
+ * @brief 通过完美哈希索引按ID查找按键
+ * @param ph 完美哈希索引
+ * @param id 按键ID
+ * @return 按键指针，未找到时返回NULL
+ * @note 只计算一次哈希、比较一次ID，与表项数无关
+ */
+nn_key_t *NN_Key_PhashFind(const nn_key_phash_t *ph, const char *id)
+{
+    uint32_t hash;
+    uint8_t index;
+
+    if (ph == NULL || id == NULL || ph->count == 0) return NULL;
+
+    hash = _NN_Key_IdHash(id);
+    index = ph->slot[_NN_Key_PhashSlot(hash, ph->disp[hash % KEY_PHASH_BUCKETS(ph->count)], ph->count)];
+    if (strcmp(ph->table[index].key_id, id) != 0) return NULL;
+
+    return &ph->keys[index];
+}
+
+/* ========================= 对象池 ========================= */
+#if KEY_POOL_KEY_NUMBER > 0
+/**
+ * @brief 从对象池创建按键并添加到按键列表
+ * @param id 按键名称
+ * @param read_func 按键读取函数
+ * @return 按键指针，对象池已满或添加失败时返回NULL
+ * @note 对象池为库内部容量KEY_POOL_KEY_NUMBER的静态数组，不使用系统堆，分配和释放均为O(1)
+ */
+nn_key_t *NN_Key_Create(const char *id, nn_key_read_t read_func)
+{
+    nn_key_t *key;
+
+    if (read_func == NULL) return NULL;
+
+    // 优先复用已释放的对象，否则取下一个从未分配过的对象
+    if (_nn_key_pool_top > 0)
+    {
+        key = &_nn_key_pool[_nn_key_pool_free[--_nn_key_pool_top]];
+    }
+    else if (_nn_key_pool_used < KEY_POOL_KEY_NUMBER)
+    {
+        key = &_nn_key_pool[_nn_key_pool_used++];
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (!NN_Key_Add(key, id, read_func))
+    {
+        _nn_key_pool_free[_nn_key_pool_top++] = (uint8_t)(key - _nn_key_pool);
+        return NULL;
+    }
+
+    return key;
+}
+
+/**
+ * @brief 删除对象池创建的按键并归还对象
+ * @param key 按键指针
+ * @return 删除是否成功，按键不属于对象池、未添加或仍是组合键成员时返回false
+ */
+bool NN_Key_Destroy(nn_key_t *key)
+{
+    if (key < _nn_key_pool || key >= _nn_key_pool + KEY_POOL_KEY_NUMBER) return false;
+
+    // 未添加的对象不能重复归还
+    if (!NN_Key_Remove(key)) return false;
+
+    _nn_key_pool_free[_nn_key_pool_top++] = (uint8_t)(key - _nn_key_pool);
+
+    return true;
+}
+#endif
+
+#if KEY_USE_COMBO && KEY_POOL_COMBO_NUMBER > 0
+/**
+ * @brief 从对象池创建组合键并添加到组合键列表
+ * @param id 组合键名称
+ * @param mem_nbr 组合键的成员数量
+ * @param member1 组合键的成员1
+ * @param member2 组合键的成员2
+ * @param ... 组合键的其他成员
+ * @return 组合键指针，对象池已满或添加失败时返回NULL
+ * @note 对象池为库内部容量KEY_POOL_COMBO_NUMBER的静态数组，不使用系统堆，分配和释放均为O(1)
+ */
+nn_comb_t *NN_Combo_Create(const char *id, uint8_t mem_nbr, nn_key_t *member1, nn_key_t *member2, ...)
+{
+    nn_key_t *members[KEY_MAX_COMBO_MEMBER] = {NULL};
+    nn_comb_t *comb;
+    va_list args;
+
+    // 成员数下限由_NN_Combo_Setup检查
+    if (mem_nbr > KEY_MAX_COMBO_MEMBER) return NULL;
+
+    // 收集成员
+    members[0] = member1;
+    members[1] = member2;
+
+    va_start(args, member2);
+    for (uint8_t i = 2; i < mem_nbr; i++)
+    {
+        members[i] = va_arg(args, nn_key_t *);
+    }
+    va_end(args);
+
+    // 优先复用已释放的对象，否则取下一个从未分配过的对象
+    if (_nn_combo_pool_top > 0)
+    {
+        comb = &_nn_combo_pool[_nn_combo_pool_free[--_nn_combo_pool_top]];
+    }
+    else if (_nn_combo_pool_used < KEY_POOL_COMBO_NUMBER)
+    {
+        comb = &_nn_combo_pool[_nn_combo_pool_used++];
+    }
+    else
+    {
+        return NULL;
+    }
+
+    memset(&comb->combo_cb, 0, sizeof(comb->combo_cb));
+    if (!_NN_Combo_Setup(comb, id, mem_nbr, members))
+    {
+        _nn_combo_pool_free[_nn_combo_pool_top++] = (uint8_t)(comb - _nn_combo_pool);
+        return NULL;
+    }
+
+    return comb;
+}
+
+/**
+ * @brief 删除对象池创建的组合键并归还对象
+ * @param comb 组合键指针
+ * @return 删除是否成功，组合键不属于对象池或未添加时返回false
+ */
+bool NN_Combo_Destroy(nn_comb_t *comb)
+{
+    if (comb < _nn_combo_pool || comb >= _nn_combo_pool + KEY_POOL_COMBO_NUMBER) return false;
+
+    // 未添加的对象不能重复归还
+    if (!NN_Combo_Remove(comb)) return false;
+
+    _nn_combo_pool_free[_nn_combo_pool_top++] = (uint8_t)(comb - _nn_combo_pool);
+
+    return true;
+}
+#endif
+
+/* ========================= 紧凑按键引擎 ========================= */
+/**
+ * @brief 初始化紧凑按键引擎
+ * @param pack 引擎指针
+ * @param keys 按键状态数组，key_num项
+ * @param due 截止时刻数组，KEY_PACK_DUE_SIZE(key_num)项，建议按32字节对齐
+ * @param words 位图存储，KEY_PACK_WORDS(key_num)个字
+ * @param key_num 按键数量
+ * @param profiles 配置模板数组，可为const
+ * @param profile_num 配置模板数量(1~16)
+ * @return 初始化是否成功，有模板的时间参数超过KEY_PACK_TIME_MAX时返回false
+ * @note 用于上万个按键的仿真台架或大型I/O面板，每个按键只占4字节状态、2字节截止时刻加2位位图，
+ *       事件语义与普通按键的默认配置(时间锁定消抖)相同，不支持组合键和按键选项
+ *       所有按键初始使用0号模板
+ */
+bool NN_KeyPack_Init(nn_keypack_t *pack,
+                     nn_keypack_key_t *keys,
+                     uint16_t *due,
+                     uint32_t *words,
+                     uint16_t key_num,
+                     const nn_keypack_profile_t *profiles,
+                     uint8_t profile_num)
+{
+    uint16_t word_num = (uint16_t)((key_num + 31) / 32);
+
+    if (pack == NULL || keys == NULL || due == NULL || words == NULL || profiles == NULL) return false;
+    if (profile_num == 0 || profile_num > 16) return false;
+
+    // 时间参数超出上限时偏移比较会出错
+    for (uint8_t i = 0; i < profile_num; i++)
+    {
+        if (profiles[i].debounce_time > KEY_PACK_TIME_MAX || profiles[i].long_time > KEY_PACK_TIME_MAX ||
+            profiles[i].long_alws_time > KEY_PACK_TIME_MAX || profiles[i].multi_time > KEY_PACK_TIME_MAX) return false;
+    }
+
+    // 状态、事件、计数和模板序号的初始值均为0
+    memset(keys, 0, key_num * sizeof(nn_keypack_key_t));
+    memset(due, 0, word_num * 32 * sizeof(uint16_t));
+    memset(words, 0, word_num * sizeof(uint32_t));
+
+    // 未初始化的按键都需运行一次状态机，截止时刻为0即立即到期
+    for (uint16_t w = 0; w < word_num; w++)
+    {
+        uint16_t base = (uint16_t)(w * 32);
+        words[word_num + w] = (key_num - base >= 32) ? 0xFFFFFFFFUL : ((1UL << (key_num - base)) - 1);
+    }
+
+    pack->pack_keys = keys;
+    pack->pack_due = due;
+    pack->pack_last = words;
+    pack->pack_busy = words + word_num;
+    pack->pack_profiles = profiles;
+    pack->pack_num = key_num;
+    pack->pack_profile_num = profile_num;
+    pack->pack_epoch = 0;
+    pack->pack_alws_last = 0;
+
+    return true;
+}
+
+/**
+ * @brief 设置紧凑引擎按键使用的配置模板
+ * @param pack 引擎指针
+ * @param index 按键序号
+ * @param profile 配置模板序号
+ * @return 设置是否成功
+ */
+bool NN_KeyPack_SetProfile(nn_keypack_t *pack, uint16_t index, uint8_t profile)
+{
+    if (pack == NULL || index >= pack->pack_num || profile >= pack->pack_profile_num) return false;
+
+    pack->pack_keys[index].kp_profile = profile;
+
+    return true;
+}
+
+/**
+ * @brief 紧凑引擎处理函数
+ * @param pack 引擎指针
+ * @param tick 当前系统时钟值(tick)
+ * @param ports 端口快照，第i位为第i个按键电平(1为按下)
+ * @return 处理是否成功
+ * @note 按字并行比较电平变化，并按32个按键一组比较截止时刻得到到期位图，
+ *       只运行电平变化或截止时刻已到的按键的状态机，无截止时刻的字跳过比较
+ *       时间戳以基准时刻的偏移保存，偏移将溢出时整体平移基准，早于所有时间参数的时间戳截断为0
+ */
+bool NN_KeyPack_Handler(nn_keypack_t *pack, nn_key_tick_t tick, const uint32_t *ports)
+{
+    nn_key_tick_t rel;
+
+    if (pack == NULL || ports == NULL) return false;
+
+    // 偏移将超出16位时平移基准，平移量之前的时间戳已超过所有时间参数
+    rel = (nn_key_tick_t)(tick - pack->pack_epoch) >> KEY_PACK_SHIFT;
+    if (rel >= 0x8000)
+    {
+        nn_key_tick_t delta = rel - 0x4000;
+
+        pack->pack_epoch += delta << KEY_PACK_SHIFT;
+        for (uint16_t i = 0; i < pack->pack_num; i++)
+        {
+            nn_keypack_key_t *key = &pack->pack_keys[i];
+            key->kp_last = (key->kp_last > delta) ? (uint16_t)(key->kp_last - delta) : 0;
+            pack->pack_due[i] = (pack->pack_due[i] > delta) ? (uint16_t)(pack->pack_due[i] - delta) : 0;
+        }
+        rel = 0x4000;
+    }
+
+    for (uint16_t w = 0; w * 32 < pack->pack_num; w++)
+    {
+        uint16_t base = (uint16_t)(w * 32);
+        uint32_t valid = (pack->pack_num - base >= 32) ? 0xFFFFFFFFUL : ((1UL << (pack->pack_num - base)) - 1);
+
+        // 需要运行状态机的按键: 电平变化或截止时刻已到
+        uint32_t active = (ports[w] ^ pack->pack_last[w]) & valid;
+        if (pack->pack_busy[w]) active |= _NN_KeyPack_Expired(&pack->pack_due[base], (uint16_t)rel) & pack->pack_busy[w];
+        pack->pack_last[w] = ports[w];
+
+        while (active)
+        {
+            uint8_t bit = 0;
+            uint16_t i;
+            nn_keypack_key_t *key;
+            bool raw;
+
+            while (!(active & (1UL << bit))) bit++;
+            active &= active - 1; // 清除最低位
+
+            i = (uint16_t)(base + bit);
+            key = &pack->pack_keys[i];
+            raw = (ports[w] >> bit) & 1;
+
+            _NN_KeyPack_Step(pack, i, (uint16_t)rel, raw);
+            if (key->kp_event != KEY_EVENT_INIT) _NN_KeyPack_Event(pack, i, tick);
+
+            // 无截止时刻的按键在电平变化前无需处理
+            if (_NN_KeyPack_Deadline(pack, i, (uint16_t)rel, raw))
+            {
+                pack->pack_busy[w] |= (1UL << bit);
+            }
+            else
+            {
+                pack->pack_busy[w] &= ~(1UL << bit);
+            }
+        }
+    }
+
+    return true;
+}
+
+/* ========================= 内部函数实现 ========================= */
+/**
+ * @brief 读取一个按键并运行状态机
+ * @param index 按键序号
+ * @param tick 当前系统时钟值(tick)
+ * @note 内部函数，边沿驱动的按键使用最近一次边沿的电平，并记录电平位图供块处理判断电平变化
+ */
+static void _NN_Key_Poll(uint8_t index, nn_key_tick_t tick)
+{
+    nn_key_t *key = _nn_key_list[index];
+    bool raw;
+
+    // 边沿驱动的按键使用最近一次边沿的电平
+    if (key->key_core->key_opts & KEY_OPT_EDGE_SOURCE)
+    {
+        raw = (_nn_key_port_last[index >> 5] >> (index & 31)) & 1;
+    }
+    else
+    {
+        raw = key->key_read();
+    }
+
+    // 记录电平位图，供块处理判断电平变化
+    if (raw)
+    {
+        _nn_key_port_last[index >> 5] |= (1UL << (index & 31));
+    }
+    else
+    {
+        _nn_key_port_last[index >> 5] &= ~(1UL << (index & 31));
+    }
+
+    // 运行按键状态机
+    _NN_Key_StateMachine(key, tick, raw);
+}
+
+/**
+ * @brief 处理一个端口快照
+ * @param ports 端口快照，占KEY_PORT_WORDS个字
+ * @param tick 快照的系统时钟值(tick)
+ * @return 事件是否全部成功处理
+ * @note 内部函数，只运行电平变化、截止时刻已到或需逐次采样且非空闲的按键的状态机，
+ *       没有按键被处理也没有组合键窗口时不分发事件
+ */
+static bool _NN_Key_Sample(const uint32_t *ports, nn_key_tick_t tick)
+{
+    bool pending = false;
+    uint32_t due[KEY_PORT_WORDS] = {0};
+    nn_key_tick_t when;
+    nn_key_timer_t *timer;
+
+#if KEY_USE_SECTION
+    // 首次调用时添加静态注册的按键和组合键
+    if (!_nn_key_reg_done) NN_Key_RegisterAll();
+#endif
+
+#if KEY_USE_COMBO
+    // 组合键窗口未结束时需要继续处理
+    for (uint8_t i = 0; i < _nn_combo_num; i++)
+    {
+        if (_nn_combo_list[i]->combo_open) pending = true;
+    }
+#endif
+
+    // 从时间轮取出到期的按键，运行状态机后会重新放入
+    while (_NN_Wheel_Next(tick, &when))
+    {
+        for (timer = _NN_Wheel_Pop(); timer != NULL; timer = timer->next)
+        {
+            if (!timer->is_combo) due[timer->index >> 5] |= (1UL << (timer->index & 31));
+            pending = true;
+        }
+    }
+
+    // 限额处理挂起的按键截止时刻已过，同样需要运行状态机
+    for (uint8_t w = 0; w * 32 < _nn_key_num; w++)
+    {
+        if (_nn_key_parked[w]) pending = true;
+        due[w] |= _nn_key_parked[w];
+    }
+
+    for (uint8_t w = 0; w * 32 < _nn_key_num; w++)
+    {
+        uint8_t base = (uint8_t)(w * 32);
+        uint32_t valid = (_nn_key_num - base >= 32) ? 0xFFFFFFFFUL : ((1UL << (_nn_key_num - base)) - 1);
+
+        // 需要运行状态机的按键: 电平变化、截止时刻已到或需逐次采样且非空闲
+        uint32_t active = ((ports[w] ^ _nn_key_port_last[w]) | due[w] |
+                           (_nn_key_sample_mask[w] & ~_nn_key_idle_mask[w])) & valid;
+        _nn_key_port_last[w] = ports[w];
+
+        while (active)
+        {
+            uint8_t bit = 0;
+            while (!(active & (1UL << bit))) bit++;
+            active &= active - 1; // 清除最低位
+
+            _NN_Key_StateMachine(_nn_key_list[base + bit], tick, (ports[w] >> bit) & 1);
+            pending = true;
+        }
+    }
+
+    // 没有按键被处理也没有组合键窗口时不会产生任何事件
+    if (!pending) return true;
+
+    return _NN_Key_Dispatch(tick);
+}
+
+/**
+ * @brief 获取按键可修改的私有配置
+ * @param key 按键指针
+ * @return 私有配置指针，KEY_PRIVATE_CONFIG为0时返回NULL
+ * @note 内部函数，使用共享模板的按键先将模板复制为私有配置再切换过去
+ */
+static nn_key_profile_t *_NN_Key_OwnProfile(nn_key_t *key)
+{
+#if KEY_PRIVATE_CONFIG
+    if (key->key_core->key_profile != &key->key_own)
+    {
+        key->key_own = *key->key_core->key_profile;
+        key->key_core->key_profile = &key->key_own;
+    }
+
+    return &key->key_own;
+#else
+    (void)key;
+
+    return NULL;
+#endif
+}
+
+/**
+ * @brief 判断采样分组本次是否到期并安排下次采样
+ * @param group 分组结构体指针
+ * @param tick 当前系统时钟值(tick)
+ * @note 内部函数，按固定周期推进下次采样时刻，调用迟到超过一个周期时从当前时刻重新计时，不补采
+ */
+static void _NN_Key_GroupSchedule(nn_key_group_t *group, nn_key_tick_t tick)
+{
+    // 首次调用立即采样
+    if (!group->group_started)
+    {
+        group->group_started = true;
+        group->group_due = true;
+        group->group_next = tick + group->group_period;
+        return;
+    }
+
+    group->group_due = !KEY_TICK_BEFORE(tick, group->group_next);
+    if (!group->group_due) return;
+
+    group->group_next += group->group_period;
+    if (!KEY_TICK_BEFORE(tick, group->group_next))
+    {
+        group->group_next = tick + group->group_period;
+    }
+}
+
+/**
+ * @brief 记录一次处理函数调用间隔
+ * @param tick 当前系统时钟值(tick)
+ * @note 内部函数，按固定桶宽累计直方图，超出范围的计入最后一桶
+ */
+static void _NN_Key_JitterRecord(nn_key_tick_t tick)
+{
+    nn_key_span_t width = KEY_MS_TO_TICK(KEY_JITTER_BUCKET_MS);
+    nn_key_tick_t diff = tick - _nn_key_poll_last;
+    nn_key_span_t interval;
+    nn_key_span_t bucket;
+
+    _nn_key_poll_last = tick;
+
+    // 第一次调用没有间隔可统计
+    if (!_nn_key_poll_valid)
+    {
+        _nn_key_poll_valid = true;
+        return;
+    }
+
+    interval = diff > UINT32_MAX ? UINT32_MAX : (nn_key_span_t)diff;
+    // 第i桶收纳(i*width, (i+1)*width]的间隔，桶上界即可作为百分位结果
+    bucket = (interval && width) ? (interval - 1) / width : 0;
+    if (bucket >= KEY_JITTER_BUCKETS) bucket = KEY_JITTER_BUCKETS - 1;
+    _nn_key_jitter_hist[bucket]++;
+
+    // 更新最值
+    if (_nn_key_jitter.count == 0 || interval < _nn_key_jitter.min) _nn_key_jitter.min = interval;
+    if (interval > _nn_key_jitter.max) _nn_key_jitter.max = interval;
+    _nn_key_jitter.last = interval;
+    _nn_key_jitter.count++;
+}
+
+/**
+ * @brief 计算按键在电平保持不变时的下一个截止时刻
+ * @param key 按键指针
+ * @param deadline 输出截止时刻
+ * @return 是否存在截止时刻
+ * @note 内部函数，截止时刻即状态机在没有新采样时也会发生变化的时刻
+ */
+static bool _NN_Key_NextDeadline(nn_key_t *key, nn_key_tick_t *deadline)
+{
+    nn_key_core_t *core = key->key_core;
+    const nn_key_paras_t *paras = &core->key_profile->key_paras;
+    bool raw = core->key_debounce.raw;
+    bool level = core->key_debounce.level;
+    bool has = false;
+    nn_key_tick_t when = 0;
+    nn_key_tick_t t;
+
+// 取更早的截止时刻
+#define _NN_KEY_EARLIER(x)                                 \
+    do                                                     \
+    {                                                      \
+        t = (x);                                           \
+        if (!has || KEY_TICK_BEFORE(t, when)) when = t;     \
+        has = true;                                        \
+    } while (0)
+
+    if (core->key_flags.state == KEY_STATE_INIT) return false;
+
+    // 消抖滤波的截止时刻
+    switch (core->key_debounce.mode)
+    {
+        case KEY_DEBOUNCE_LOCKOUT:
+            if (raw && !level) _NN_KEY_EARLIER(core->key_last_time + core->key_debounce.press_time);
+            break;
+
+        case KEY_DEBOUNCE_EAGER:
+            if (raw != level) _NN_KEY_EARLIER(core->key_debounce.stable_time + core->key_debounce.press_time);
+            break;
+
+        case KEY_DEBOUNCE_ASYMMETRIC:
+            if (raw != level)
+            {
+                _NN_KEY_EARLIER(core->key_debounce.raw_time +
+                                (raw ? core->key_debounce.press_time : key->key_tune.release_time));
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (core->key_debounce.measuring)
+    {
+        _NN_KEY_EARLIER(core->key_debounce.stable_time + key->key_tune.adapt_max);
+    }
+
+    // 状态机的截止时刻
+    switch (core->key_flags.state)
+    {
+        case KEY_STATE_PRESSED:
+            if (!level) break;
+            if (core->key_opts & KEY_OPT_LONG_ON_HOLD)
+            {
+                _NN_KEY_EARLIER(core->key_deadline);
+            }
+            else if (_NN_KEY_ALWS_ON(paras) && paras->long_time < paras->long_alws_time)
+            {
+                _NN_KEY_EARLIER(core->key_last_time + paras->long_time);
+            }
+            if (_NN_KEY_ALWS_ON(paras))
+            {
+                _NN_KEY_EARLIER(core->key_last_time + paras->long_alws_time);
+            }
+            break;
+
+        case KEY_STATE_LONG_PRESSED:
+            if (level && _NN_KEY_ALWS_ON(paras))
+            {
+                _NN_KEY_EARLIER(core->key_last_time + paras->long_alws_time);
+            }
+            break;
+
+#if KEY_USE_LONG_ALWS
+        case KEY_STATE_LONG_PRESSED_ALWS:
+            // 有回调时按回调间隔重复触发，被组合键锁定期间不触发
+            if (level && !core->key_flags.lock_flag && (core->key_profile->callback_mask & (0x01 << KEY_EVENT_LONG_PRESSED_ALWS)))
+            {
+                _NN_KEY_EARLIER(_nn_key_alws_last + KEY_MS_TO_TICK(KEY_LONG_PRESS_ALWS_CB));
+            }
+            break;
+#endif
+
+#if KEY_USE_MULTI
+        case KEY_STATE_MULTI_PRESSED:
+            if (!level) _NN_KEY_EARLIER(core->key_last_time + paras->multi_time);
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+#undef _NN_KEY_EARLIER
+
+    *deadline = when;
+    return has;
+}
+
+/**
+ * @brief 按当前状态重新安排按键的截止时刻定时器
+ * @param key 按键指针
+ * @note 内部函数，截止时刻未变化时不操作时间轮
+ */
+static void _NN_Key_TimerArm(nn_key_t *key)
+{
+    nn_key_tick_t deadline;
+
+    if (!_NN_Key_NextDeadline(key, &deadline))
+    {
+        _NN_Wheel_Remove(&key->key_timer);
+        return;
+    }
+
+    if (key->key_timer.linked && key->key_timer.expire == deadline) return;
+
+    _NN_Wheel_Remove(&key->key_timer);
+    _NN_Wheel_Insert(&key->key_timer, deadline);
+}
+
+#if KEY_USE_COMBO
+/**
+ * @brief 按当前状态重新安排组合键的窗口超时定时器
+ * @param comb 组合键指针
+ * @note 内部函数，窗口超时即组合键处理中判定超时的第一个时刻
+ */
+static void _NN_Combo_TimerArm(nn_comb_t *comb)
+{
+    nn_key_tick_t deadline = comb->combo_mem_first + comb->combo_window + 1;
+
+    if (!comb->combo_open)
+    {
+        _NN_Wheel_Remove(&comb->combo_timer);
+        return;
+    }
+
+    if (comb->combo_timer.linked && comb->combo_timer.expire == deadline) return;
+
+    _NN_Wheel_Remove(&comb->combo_timer);
+    _NN_Wheel_Insert(&comb->combo_timer, deadline);
+}
+#endif
+
+/**
+ * @brief 整理不晚于tick的定时器
+ * @param tick 当前系统时钟值(tick)
+ * @param park 是否挂起截止时刻已过的按键(限额处理时未轮到的按键)
+ * @note 内部函数，在按键于tick运行过状态机后调用，只需重新安排到期的定时器；
+ *       所属分组未到期的按键推迟到分组下次采样时刻；挂起的按键移出时间轮，
+ *       运行状态机时重新放入，避免每次调用都重复整理
+ */
+static void _NN_Key_TimerSettle(nn_key_tick_t tick, bool park)
+{
+    nn_key_tick_t when;
+    nn_key_timer_t *timer;
+    nn_key_timer_t *following;
+
+    while (_NN_Wheel_Next(tick, &when))
+    {
+        for (timer = _NN_Wheel_Pop(); timer != NULL; timer = following)
+        {
+            following = timer->next; // 重新放入时间轮会改写链表指针
+#if KEY_USE_COMBO
+            if (timer->is_combo)
+            {
+                _NN_Combo_TimerArm(_nn_combo_list[timer->index]);
+            }
+            else
+#endif
+            {
+                nn_key_t *key = _nn_key_list[timer->index];
+
+                if (key->key_group && !key->key_group->group_due)
+                {
+                    _NN_Wheel_Insert(timer, key->key_group->group_next);
+                }
+                else
+                {
+                    _NN_Key_TimerArm(key);
+                    if (park && timer->linked && !KEY_TICK_BEFORE(tick, timer->expire))
+                    {
+                        _NN_Wheel_Remove(timer);
+                        _nn_key_parked[timer->index >> 5] |= (1UL << (timer->index & 31));
+                    }
+                }
+            }
+
+            // 已处理过仍未推后的截止时刻放到下一个tick，保证本次整理能够结束
+            if (timer->linked && !KEY_TICK_BEFORE(tick, timer->expire))
+            {
+                _NN_Wheel_Remove(timer);
+                _NN_Wheel_Insert(timer, tick + 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 将定时器放入时间轮
+ * @param timer 定时器指针(不能已在时间轮中)
+ * @param expire 到期时刻
+ * @note 内部函数，O(1)；已过期的放在当前格，超出范围的放在最高层最远一格，取出时重新放入
+ */
+static void _NN_Wheel_Insert(nn_key_timer_t *timer, nn_key_tick_t expire)
+{
+    nn_key_tick_t at = expire;
+    nn_key_tick_t delta;
+    uint8_t level = 0;
+    uint8_t slot;
+
+    if (KEY_TICK_BEFORE(at, _nn_wheel_base)) at = _nn_wheel_base;
+    delta = at - _nn_wheel_base;
+
+    if (delta >> (_NN_WHEEL_BITS * KEY_WHEEL_LEVELS))
+    {
+        delta = ((nn_key_tick_t)1 << (_NN_WHEEL_BITS * KEY_WHEEL_LEVELS)) - 1;
+        at = _nn_wheel_base + delta;
+    }
+
+    while (level < KEY_WHEEL_LEVELS - 1 && (delta >> (_NN_WHEEL_BITS * (level + 1))))
+    {
+        level++;
+    }
+    slot = (uint8_t)((at >> (_NN_WHEEL_BITS * level)) & _NN_WHEEL_MASK);
+
+    // 插入链表头部
+    timer->expire = expire;
+    timer->slot = (uint8_t)((level << _NN_WHEEL_BITS) | slot);
+    timer->prev = NULL;
+    timer->next = _nn_wheel[level][slot];
+    if (timer->next) timer->next->prev = timer;
+    _nn_wheel[level][slot] = timer;
+    _nn_wheel_map[level] |= (1UL << slot);
+    timer->linked = true;
+    _nn_wheel_count++;
+}
+
+/**
+ * @brief 将定时器移出时间轮
+ * @param timer 定时器指针
+ * @note 内部函数，O(1)，不在时间轮中时不操作
+ */
+static void _NN_Wheel_Remove(nn_key_timer_t *timer)
+{
+    uint8_t level = timer->slot >> _NN_WHEEL_BITS;
+    uint8_t slot = timer->slot & _NN_WHEEL_MASK;
+
+    if (!timer->linked) return;
+
+    if (timer->prev)
+    {
+        timer->prev->next = timer->next;
+    }
+    else
+    {
+        _nn_wheel[level][slot] = timer->next;
+    }
+    if (timer->next) timer->next->prev = timer->prev;
+
+    if (_nn_wheel[level][slot] == NULL) _nn_wheel_map[level] &= ~(1UL << slot);
+    timer->linked = false;
+    _nn_wheel_count--;
+}
+
+/**
+ * @brief 估计时间轮中最早的到期时刻
+ * @param when 输出时刻，不晚于实际最早的到期时刻
+ * @return 时间轮是否非空
+ * @note 内部函数，第0层为精确值，更高层为最早非空格的起始时刻，开销与按键数量无关
+ */
+static bool _NN_Wheel_Peek(nn_key_tick_t *when)
+{
+    bool has = false;
+
+    if (_nn_wheel_count == 0) return false;
+
+    for (uint8_t level = 0; level < KEY_WHEEL_LEVELS; level++)
+    {
+        uint32_t map = _nn_wheel_map[level];
+        uint8_t shift = (uint8_t)(_NN_WHEEL_BITS * level);
+        uint8_t cur = (uint8_t)((_nn_wheel_base >> shift) & _NN_WHEEL_MASK);
+        uint8_t offset;
+        nn_key_tick_t t;
+
+        if (!map) continue;
+
+        // 第0层从当前格开始找，更高层的当前格已展开，其中的定时器属于下一圈
+        offset = (level == 0) ? 0 : 1;
+        while (!(map & (1UL << ((cur + offset) & _NN_WHEEL_MASK)))) offset++;
+
+        if (level == 0)
+        {
+            t = _nn_wheel_base + offset;
+        }
+        else
+        {
+            t = ((_nn_wheel_base >> shift) + offset) << shift;
+        }
+
+        if (!has || KEY_TICK_BEFORE(t, *when)) *when = t;
+        has = true;
+    }
+
+    return has;
+}
+
+/**
+ * @brief 推进时间轮到下一个不晚于limit的到期时刻
+ * @param limit 推进的上限时刻
+ * @param when 输出到期时刻
+ * @return 是否有到期的定时器，有则可用_NN_Wheel_Pop取出
+ * @note 内部函数，跳过空格直接推进，跨过高层格边界时将该格的定时器展开到低层
+ */
+static bool _NN_Wheel_Next(nn_key_tick_t limit, nn_key_tick_t *when)
+{
+    nn_key_tick_t next;
+
+    // 时间轮为空时直接对齐到limit
+    if (_nn_wheel_count == 0)
+    {
+        _nn_wheel_base = limit;
+        return false;
+    }
+
+    if (KEY_TICK_BEFORE(limit, _nn_wheel_base)) return false;
+
+    for (;;)
+    {
+        // 当前格有定时器即为到期
+        if (_nn_wheel_map[0] & (1UL << (_nn_wheel_base & _NN_WHEEL_MASK)))
+        {
+            *when = _nn_wheel_base;
+            return true;
+        }
+
+        if (!_NN_Wheel_Peek(&next) || KEY_TICK_BEFORE(limit, next)) next = limit;
+        if (next == _nn_wheel_base) return false;
+
+        // 推进到下一个可能到期的时刻，途经的格均为空
+        _nn_wheel_base = next;
+
+        // 从高层到低层展开对齐边界的格
+        for (uint8_t level = KEY_WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            uint8_t shift = (uint8_t)(_NN_WHEEL_BITS * level);
+            uint8_t slot;
+            nn_key_timer_t *timer;
+
+            if (_nn_wheel_base & ((((nn_key_tick_t)1) << shift) - 1)) continue;
+
+            slot = (uint8_t)((_nn_wheel_base >> shift) & _NN_WHEEL_MASK);
+            timer = _nn_wheel[level][slot];
+            while (timer)
+            {
+                nn_key_timer_t *following = timer->next;
+
+                _NN_Wheel_Remove(timer);
+                _NN_Wheel_Insert(timer, timer->expire);
+                timer = following;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 取出当前格的全部定时器
+ * @return 以next串联的定时器链表，当前格为空时返回NULL
+ * @note 内部函数，需先由_NN_Wheel_Next推进到到期时刻；整格取出后再处理，
+ *       处理中重新放入当前格的定时器(如持续长按回调前的重复截止时刻)留到下一轮
+ */
+static nn_key_timer_t *_NN_Wheel_Pop(void)
+{
+    uint8_t slot = _nn_wheel_base & _NN_WHEEL_MASK;
+    nn_key_timer_t *list = _nn_wheel[0][slot];
+
+    for (nn_key_timer_t *timer = list; timer != NULL; timer = timer->next)
+    {
+        timer->linked = false;
+        _nn_wheel_count--;
+    }
+
+    _nn_wheel[0][slot] = NULL;
+    _nn_wheel_map[0] &= ~(1UL << slot);
+
+    return list;
+}
+
+/**
+ * @brief 按时间顺序处理缓冲区中的边沿
+ * @param tick 当前系统时钟值(tick)
+ * @return 事件是否全部成功处理
+ * @note 内部函数，每个边沿先追赶结算此前到期的超时，再以新电平在边沿时刻运行状态机，
+ *       使按下/释放时间取边沿的精确时间戳而非轮询时刻
+ *       晚于tick的边沿留到下一次处理；存在边沿驱动的按键时，最后一个边沿到tick之间的截止时刻
+ *       也按实际时刻结算，不再取整到处理函数的调用时刻
+ */
+static bool _NN_Key_EdgeDrain(nn_key_tick_t tick)
+{
+    bool result = true;
+    uint16_t tail = _nn_key_edge_tail;
+
+    if (tail == _nn_key_edge_head && _nn_key_edge_num == 0) return true;
+
+    while (tail != _nn_key_edge_head)
+    {
+        volatile nn_key_edge_t *edge = &_nn_key_edge_fifo[tail & (KEY_EDGE_FIFO_SIZE - 1)];
+        nn_key_tick_t edge_tick = edge->tick;
+        uint8_t i = edge->index;
+        bool level = edge->level;
+
+        if (KEY_TICK_BEFORE(tick, edge_tick)) break;
+        tail++;
+
+        if (i >= _nn_key_num) continue;
+
+        // 按时间顺序结算边沿之前到期的超时
+        result &= NN_Key_CatchUp(edge_tick);
+
+        // 以新电平处理边沿
+        if (level)
+        {
+            _nn_key_port_last[i >> 5] |= (1UL << (i & 31));
+        }
+        else
+        {
+            _nn_key_port_last[i >> 5] &= ~(1UL << (i & 31));
+        }
+        _NN_Key_StateMachine(_nn_key_list[i], edge_tick, level);
+
+        result &= _NN_Key_Dispatch(edge_tick);
+    }
+
+    _nn_key_edge_tail = tail;
+
+    // 结算最后一个边沿之后、tick之前到期的超时
+    result &= NN_Key_CatchUp(tick);
+
+    return result;
+}
+
+/**
+ * @brief 处理组合键和所有按键事件
+ * @param tick 当前系统时钟值(tick)
+ * @return 事件是否全部成功处理
+ * @note 内部函数，在状态机运行之后调用，只处理本轮运行过状态机的按键和组合键成员，
+ *       其余按键没有新事件，状态和位图也不会变化；开销与本轮处理的按键数成正比，与按键总数无关
+ *       (待分发位图按字扫描，每32个按键一次字比较)
+ */
+static bool _NN_Key_Dispatch(nn_key_tick_t tick)
+{
+    bool result = true;
+
+#if KEY_USE_COMBO
+    // 首先重置所有组合键成员的锁定状态，成员可能有被锁定而未分发的事件，一并处理
+    for (uint8_t i = 0; i < _nn_combo_num; i++)
+    {
+        nn_comb_t *comb = _nn_combo_list[i];
+
+        for (uint8_t k = 0; k < comb->combo_member_nbr; k++)
+        {
+            nn_key_t *mem_key = comb->combo_member[k];
+
+            if (mem_key == NULL) continue;
+            mem_key->key_core->key_flags.lock_flag = false; // 重置组合键锁定状态
+            _nn_key_touch[mem_key->key_timer.index >> 5] |= (1UL << (mem_key->key_timer.index & 31));
+        }
+    }
+
+    // 处理组合键
+    _NN_Combo_Process(tick);
+#endif
+    _nn_key_last_tick = tick;
+
+    // 按序号处理待分发的按键
+    for (uint8_t w = 0; w * 32 < _nn_key_num; w++)
+    {
+        uint32_t touch = _nn_key_touch[w];
+
+        _nn_key_touch[w] = 0;
+        while (touch)
+        {
+            uint8_t bit = 0;
+            uint8_t i;
+            nn_key_core_t *core;
+
+            while (!(touch & (1UL << bit))) bit++;
+            touch &= touch - 1; // 清除最低位
+
+            i = (uint8_t)(w * 32 + bit);
+            core = &_nn_key_core[i];
+
+            // 如果按键被组合键锁定，跳过处理
+            if (!core->key_flags.lock_flag)
+            {
+                // 处理按键事件，没有事件时不访问按键结构体
+                if (core->key_flags.event != KEY_EVENT_INIT) result &= _NN_Key_Event(_nn_key_list[i], tick);
+
+#if KEY_USE_LONG_ALWS
+                // 持续长按回调后，重复截止时刻随回调时间推后
+                if (core->key_flags.state == KEY_STATE_LONG_PRESSED_ALWS) _NN_Key_TimerArm(_nn_key_list[i]);
+#endif
+            }
+
+            _NN_Key_MaskUpdate(i);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief 刷新按键的空闲位和逐次采样位
+ * @param index 按键序号
+ * @note 内部函数，在按键状态、事件或消抖策略变化后调用
+ */
+static void _NN_Key_MaskUpdate(uint8_t index)
+{
+    const nn_key_core_t *core = &_nn_key_core[index];
+    uint32_t bit = 1UL << (index & 31);
+
+    // 刷新空闲位图
+    if (_NN_Key_IsIdle(core))
+    {
+        _nn_key_idle_mask[index >> 5] |= bit;
+    }
+    else
+    {
+        _nn_key_idle_mask[index >> 5] &= ~bit;
+    }
+
+    // 刷新逐次采样位图，其余按键电平不变时只在截止时刻需要运行状态机
+    if (core->key_flags.state == KEY_STATE_INIT || core->key_debounce.mode == KEY_DEBOUNCE_INTEGRATOR ||
+        core->key_debounce.mode == KEY_DEBOUNCE_SHIFT)
+    {
+        _nn_key_sample_mask[index >> 5] |= bit;
+    }
+    else
+    {
+        _nn_key_sample_mask[index >> 5] &= ~bit;
+    }
+}
+
+/**
+ * @brief 判断按键是否已添加到按键列表
+ * @param key 按键指针
+ * @return 是否已添加
+ * @note 内部函数，O(1)，定时器序号即按键在列表中的位置
+ */
+static bool _NN_Key_Listed(const nn_key_t *key)
+{
+    return key->key_core != NULL && key->key_timer.index < _nn_key_num && _nn_key_list[key->key_timer.index] == key;
+}
+
+/**
+ * @brief 判断按键是否空闲
+ * @param key 按键指针
+ * @return 是否空闲
+ * @note 内部函数，空闲指处于释放状态、无待处理事件且消抖滤波已稳定，
+ *       此时只要电平保持释放，运行状态机不会产生任何变化
+ */
+static bool _NN_Key_IsIdle(const nn_key_core_t *core)
+{
+    return core->key_flags.state == KEY_STATE_RELEASED && core->key_flags.event == KEY_EVENT_INIT &&
+           !core->key_debounce.level && !core->key_debounce.raw && !core->key_debounce.count &&
+           !core->key_debounce.history && !core->key_debounce.measuring;
+}
+
+/**
+ * @brief 处理按键事件并执行对应回调
+ * @param key 按键指针
+ * @param tick 当前系统时钟值(tick)
+ * @return 事件是否成功处理
+ * @note 内部函数，处理事件的回调触发
+ */
+static bool _NN_Key_Event(nn_key_t *key, nn_key_tick_t tick)
+{
+    // 参数检查
+    if (key == NULL) return false;
+
+    // 初始化状态不需要处理
+    if (key->key_core->key_flags.event == KEY_EVENT_INIT) return true;
+
+    nn_key_event_t event = (nn_key_event_t)key->key_core->key_flags.event;
+    const nn_key_profile_t *profile = key->key_core->key_profile;
+
+    // 检查此事件是否有回调函数
+    if ((profile->callback_mask & (0x01 << event)) && profile->callbacks[event].func.callback_key != NULL)
+    {
+#if KEY_USE_LONG_ALWS
+        // 对于持续长按状态，需要持续触发回调
+        if (event == KEY_EVENT_LONG_PRESSED_ALWS)
+        {
+            // 为长按持续状态，每KEY_LONG_PRESS_ALWS_CB毫秒触发一次回调
+            if ((tick - _nn_key_alws_last) >= KEY_MS_TO_TICK(KEY_LONG_PRESS_ALWS_CB))
+            {
+                _nn_key_alws_last = tick; // 更新上次触发时间
+                profile->callbacks[event].func.callback_key(key, event, profile->callbacks[event].user_data);
+            }
+            return true;
+        }
+#else
+        (void)tick;
+#endif
+
+        // 调用回调函数
+        profile->callbacks[event].func.callback_key(key, event, profile->callbacks[event].user_data);
+
+        // 非持续性事件触发一次后重置为初始事件，防止重复触发
+        if (event != KEY_EVENT_LONG_PRESSED_ALWS)
+        {
+            key->key_core->key_flags.event = KEY_EVENT_INIT;
+        }
+
+        return true;
+    }
+
+    // 没有回调函数但有事件，也重置为初始状态防止重复处理
+    if (key->key_core->key_flags.event != KEY_EVENT_LONG_PRESSED_ALWS)
+    {
+        key->key_core->key_flags.event = KEY_EVENT_INIT;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 按键消抖滤波
+ * @param key 按键指针
+ * @param raw 原始电平
+ * @param tick 当前系统时钟值(tick)
+ * @return 消抖后的稳定电平
+ * @note 内部函数，按按键的消抖策略处理一次采样，开销见nn_key_debounce_t
+ */
+static bool _NN_Key_Debounce(nn_key_t *key, bool raw, nn_key_tick_t tick)
+{
+    nn_key_core_t *core = key->key_core;
+    bool level = core->key_debounce.level;
+
+    // 初始状态直接采用原始电平
+    if (core->key_flags.state == KEY_STATE_INIT)
+    {
+        core->key_debounce.level = raw;
+        core->key_debounce.raw = raw;
+        core->key_debounce.count = raw ? key->key_tune.samples : 0;
+        core->key_debounce.history = raw ? 0xFFFF : 0;
+        core->key_debounce.stable_time = tick;
+        core->key_debounce.raw_time = tick;
+        return raw;
+    }
+
+    // 记录原始电平跳变时间
+    if (raw != core->key_debounce.raw)
+    {
+        core->key_debounce.raw = raw;
+        core->key_debounce.raw_time = tick;
+
+        // 测量窗口内原始电平回到稳定电平，视为一次抖动
+        if (core->key_debounce.measuring && raw == level)
+        {
+            key->key_tune.bounce_obs = (nn_key_span_t)(tick - core->key_debounce.stable_time);
+        }
+    }
+
+    // 测量窗口结束，更新抖动估计
+    if (core->key_debounce.measuring && tick - core->key_debounce.stable_time >= key->key_tune.adapt_max)
+    {
+        _NN_Key_BounceUpdate(key);
+    }
+
+    switch (core->key_debounce.mode)
+    {
+        case KEY_DEBOUNCE_LOCKOUT:
+            // 释放立即生效，按下需距上次状态切换满消抖时间
+            if (!raw || tick - core->key_last_time >= core->key_debounce.press_time)
+            {
+                level = raw;
+            }
+            break;
+
+        case KEY_DEBOUNCE_EAGER:
+            // 锁定期外的第一个跳变立即生效
+            if (tick - core->key_debounce.stable_time >= core->key_debounce.press_time)
+            {
+                level = raw;
+            }
+            break;
+
+        case KEY_DEBOUNCE_INTEGRATOR:
+            if (raw && core->key_debounce.count < key->key_tune.samples)
+            {
+                core->key_debounce.count++;
+            }
+            else if (!raw && core->key_debounce.count > 0)
+            {
+                core->key_debounce.count--;
+            }
+
+            if (core->key_debounce.count == 0)
+            {
+                level = false;
+            }
+            else if (core->key_debounce.count >= key->key_tune.samples)
+            {
+                level = true;
+            }
+            break;
+
+        case KEY_DEBOUNCE_SHIFT:
+        {
+            uint16_t mask = (uint16_t)(0xFFFF >> (16 - key->key_tune.samples));
+
+            core->key_debounce.history = (uint16_t)((core->key_debounce.history << 1) | raw);
+            if ((core->key_debounce.history & mask) == mask)
+            {
+                level = true;
+            }
+            else if ((core->key_debounce.history & mask) == 0)
+            {
+                level = false;
+            }
+            break;
+        }
+
+        case KEY_DEBOUNCE_ASYMMETRIC:
+            // 原始电平需保持对应方向的消抖时间
+            if (tick - core->key_debounce.raw_time >=
+                (raw ? core->key_debounce.press_time : key->key_tune.release_time))
+            {
+                level = raw;
             }
             break;
 
         default:
+            level = raw;
+            break;
+    }
+
+    // 记录稳定电平跳变时间
+    if (level != core->key_debounce.level)
+    {
+        // 上一个测量窗口未结束即再次跳变，先按已有观测结算
+        if (core->key_debounce.measuring)
+        {
+            _NN_Key_BounceUpdate(key);
+        }
+
+        core->key_debounce.level = level;
+        core->key_debounce.stable_time = tick;
+
+        // 开始测量本次跳变后的抖动
+        if (core->key_opts & KEY_OPT_ADAPTIVE_DEBOUNCE)
+        {
+            core->key_debounce.measuring = true;
+            key->key_tune.bounce_obs = 0;
+        }
+    }
+
+    return level;
+}
+
+/**
+ * @brief 根据一次抖动观测更新估计值和消抖时间
+ * @param key 按键指针
+ * @note 内部函数，估计值为滑动平均(增大取1/2权重快速跟上，减小取1/8权重缓慢收敛)，
+ *       消抖时间为估计值乘以KEY_DEBOUNCE_MARGIN并限定在上下限内
+ */
+static void _NN_Key_BounceUpdate(nn_key_t *key)
+{
+    nn_key_core_t *core = key->key_core;
+    int64_t est = key->key_tune.bounce_est;
+    int64_t obs = (int64_t)key->key_tune.bounce_obs << 4;
+    uint64_t time;
+
+    core->key_debounce.measuring = false;
+
+    // 非对称滑动平均，宁可偏大也不漏判抖动
+    est += (obs > est) ? (obs - est) / 2 : (obs - est) / 8;
+    key->key_tune.bounce_est = (nn_key_span_t)(est > UINT32_MAX ? UINT32_MAX : est);
+
+    // 换算为消抖时间(向上取整)并限幅
+    time = ((uint64_t)key->key_tune.bounce_est * KEY_DEBOUNCE_MARGIN + 15) >> 4;
+    if (time < key->key_tune.adapt_min) time = key->key_tune.adapt_min;
+    if (time > key->key_tune.adapt_max) time = key->key_tune.adapt_max;
+
+    core->key_debounce.press_time = (nn_key_span_t)time;
+}
+
+/**
+ * @brief 按键状态机处理函数
+ * @param key 按键指针
+ * @param tick 当前系统时钟值(tick)
+ * @param raw 按键原始电平(按下为true，释放为false)
+ * @details 该函数实现按键状态转换的核心逻辑，包括:
+ *          - 消抖处理
+ *          - 短按/长按/持续长按识别
+ *          - 多次连击检测
+ *          - 各种事件状态的切换与生成
+ *          状态转换由_NN_KEY_TRANSITIONS生成的转换表决定，本函数只合成截止时刻位图、查表并执行动作
+ * @note 内部函数，由NN_Key_Handler和NN_Key_HandlerBlock调用
+ */
+static void _NN_Key_StateMachine(nn_key_t *key, nn_key_tick_t tick, bool raw)
+{
+    nn_key_core_t *core = key->key_core;
+    const nn_key_paras_t *paras = &core->key_profile->key_paras;
+    nn_key_tick_t now_tick = tick; // 当前系统时钟值
+    nn_key_tick_t diff_tick = now_tick - core->key_last_time; // 计算时间差，用于判断按键状态变化时间
+    bool key_val = _NN_Key_Debounce(key, raw, now_tick); // 消抖后的按键状态（按下为true，释放为false）
+    bool alws_on = _NN_KEY_ALWS_ON(paras); // 是否开启持续长按
+    const nn_key_trans_t *trans;
+    uint8_t hit;
+
+    // 各类截止时刻是否已到，无分支地合成位图
+    hit = (uint8_t)((((core->key_opts & KEY_OPT_LONG_ON_HOLD) && !KEY_TICK_BEFORE(now_tick, core->key_deadline))
+                     << _NN_KEY_CLS_HOLD) |
+                    ((alws_on && diff_tick >= paras->long_alws_time) << _NN_KEY_CLS_ALWS) |
+                    ((alws_on && diff_tick >= paras->long_time) << _NN_KEY_CLS_STAGE) |
+                    ((diff_tick >= paras->long_time) << _NN_KEY_CLS_LONG) |
+                    ((diff_tick >= paras->multi_time) << _NN_KEY_CLS_MULTI));
+
+    // 查表得到下一状态和动作
+    trans = _NN_Key_Transition(core->key_flags.state, key_val, hit);
+    if (trans->action != _NN_KEY_ACT_STAY) core->key_flags.state = (nn_key_state_t)trans->next;
+
+    switch (trans->action)
+    {
+        case _NN_KEY_ACT_SETTLE:
+            // 初始电平为释放
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_flags.event = KEY_EVENT_INIT; // 设置初始化事件
+            break;
+
+        case _NN_KEY_ACT_PRESS:
+            // 检测到消抖后的按键按下
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_deadline = now_tick + paras->long_time; // 预先计算长按截止时间
+            core->key_flags.event = KEY_EVENT_INIT; // 重置事件状态
+            core->key_seq++; // 新的手势
+            break;
+
+        case _NN_KEY_ACT_LONG_UP:
+            // 按下时间超过长按阈值，判定为长按
+            core->key_flags.event = KEY_EVENT_LONG_PRESSED;
+            core->key_last_time = now_tick;
+            core->key_multi_paras.multi_count = 0; // 重置多击计数
+            break;
+
+        case _NN_KEY_ACT_LONG_HOLD:
+            // 按住达到长按截止时间，立即触发长按事件
+            // 时间戳保持为按下时刻，持续长按仍从按下开始计时
+            core->key_flags.event = KEY_EVENT_LONG_PRESSED;
+            core->key_multi_paras.multi_count = 0; // 重置多击计数
+            break;
+
+        case _NN_KEY_ACT_LONG_END:
+            // 长按状态释放则触发长按事件 (按住触发模式下已触发过，不再重复)
+            if (!(core->key_opts & KEY_OPT_LONG_ON_HOLD))
+            {
+                core->key_flags.event = KEY_EVENT_LONG_PRESSED;
+            }
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_multi_paras.multi_count = 0; // 重置多击计数
+            break;
+
+#if KEY_USE_MULTI
+        case _NN_KEY_ACT_CLICK:
+            // 短按，进入多击检测状态
+            core->key_multi_paras.multi_count++; // 增加点击计数
+            core->key_last_time = now_tick; // 更新时间戳
+
+            // 预发模式下第一次释放立即发出单击，无需等待连按窗口
+            if ((core->key_opts & KEY_OPT_SPECULATIVE) && core->key_multi_paras.multi_count == 1)
+            {
+                core->key_flags.event = KEY_EVENT_PRESSED;
+            }
+            break;
+
+        case _NN_KEY_ACT_REPRESS:
+            // 在多击等待期间检测到新的按下
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_deadline = now_tick + paras->long_time; // 预先计算长按截止时间
+
+            // 预发模式下已发出的单击作废，通知撤回
+            if ((core->key_opts & KEY_OPT_SPECULATIVE) && core->key_multi_paras.multi_count == 1)
+            {
+                core->key_flags.event = KEY_EVENT_CLICK_RETRACT;
+            }
+            break;
+
+        case _NN_KEY_ACT_MULTI_END:
+            // 超过多击等待时间，根据累计的点击次数设置对应的事件类型
+            if (core->key_multi_paras.multi_count == 1)
+            {
+                // 预发模式下单击已在释放时发出，这里不再重复
+                if (!(core->key_opts & KEY_OPT_SPECULATIVE))
+                {
+                    core->key_flags.event = KEY_EVENT_PRESSED; // 单击
+                }
+            }
+            else if (core->key_multi_paras.multi_count == 2)
+            {
+                core->key_flags.event = KEY_EVENT_DOUBLE_PRESSED; // 双击
+            }
+            else if (core->key_multi_paras.multi_count == 3)
+            {
+                core->key_flags.event = KEY_EVENT_TRIPLE_PRESSED; // 三击
+            }
+            else if (core->key_multi_paras.multi_count > 3)
+            {
+                core->key_flags.event = KEY_EVENT_MULTI_PRESSED; // 多击（超过三次）
+            }
+
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_multi_paras.multi_count = 0; // 重置多击计数器
+            break;
+#else
+        case _NN_KEY_ACT_TAP:
+            // 短按，没有连按检测时立即产生单击
+            core->key_flags.event = KEY_EVENT_PRESSED;
+            core->key_last_time = now_tick; // 更新时间戳
+            break;
+#endif
+
+#if KEY_USE_LONG_ALWS
+        case _NN_KEY_ACT_ALWS:
+            // 按键持续按下超过持续长按阈值时间
+            core->key_flags.event = KEY_EVENT_LONG_PRESSED_ALWS;
+            core->key_last_time = now_tick; // 更新时间戳
+            break;
+
+        case _NN_KEY_ACT_ALWS_HOLD:
+            // 按键仍然保持按下，持续触发持续长按事件
+            core->key_flags.event = KEY_EVENT_LONG_PRESSED_ALWS;
+            break;
+
+        case _NN_KEY_ACT_ALWS_END:
+            // 持续长按后按键被释放
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_flags.event = KEY_EVENT_INIT; // 重置事件为初始状态，确保不会继续触发
+            core->key_multi_paras.multi_count = 0; // 重置多击计数
+            break;
+#endif
+
+        case _NN_KEY_ACT_RESET:
             // 未知状态处理，重置到初始状态
-            key->key_flags.state = KEY_STATE_INIT; // 回到初始状态
-            key->key_last_time = now_tick; // 更新时间戳
-            key->key_multi_paras.multi_count = 0; // 重置多击计数
-            key->key_flags.event = KEY_EVENT_INIT; // 重置事件类型
+            core->key_last_time = now_tick; // 更新时间戳
+            core->key_multi_paras.multi_count = 0; // 重置多击计数
+            core->key_flags.event = KEY_EVENT_INIT; // 重置事件类型
+            break;
+
+        default:
+            break;
+    }
+
+    // 状态变化后更新下一个截止时刻，并记录到待分发位图
+    _NN_Key_TimerArm(key);
+    _nn_key_touch[key->key_timer.index >> 5] |= (1UL << (key->key_timer.index & 31));
+    _nn_key_parked[key->key_timer.index >> 5] &= ~(1UL << (key->key_timer.index & 31));
+}
+
+/**
+ * @brief 查找状态转换
+ * @param state 当前状态
+ * @param level 消抖后的电平
+ * @param hit 已到达的截止时刻位图，第c位对应类别c
+ * @return 状态转换表项
+ * @note 内部函数，多个截止时刻同时到达时取表中有对应项的最高优先级类别，均无对应项时按无截止时刻查表
+ */
+static const nn_key_trans_t *_NN_Key_Transition(uint8_t state, bool level, uint8_t hit)
+{
+    const nn_key_trans_t *row;
+
+    if (state > KEY_STATE_MULTI_PRESSED) return &_nn_key_trans_reset;
+
+    row = _nn_key_trans[state][level];
+    for (uint8_t cls = _NN_KEY_CLS_NONE + 1; hit >> cls; cls++)
+    {
+        if (((hit >> cls) & 1) && row[cls].action != _NN_KEY_ACT_STAY) return &row[cls];
+    }
+
+    return &row[_NN_KEY_CLS_NONE];
+}
+
+/**
+ * @brief 紧凑引擎按键状态机
+ * @param pack 引擎指针
+ * @param index 按键序号
+ * @param now 当前时刻(相对基准)
+ * @param raw 按键原始电平(按下为true，释放为false)
+ * @note 内部函数，与_NN_Key_StateMachine共用状态转换表，在时间锁定消抖、无按键选项时的转换一致；
+ *       消抖后的电平可由状态得出，无需单独保存
+ */
+static void _NN_KeyPack_Step(nn_keypack_t *pack, uint16_t index, uint16_t now, bool raw)
+{
+    nn_keypack_key_t *key = &pack->pack_keys[index];
+    const nn_keypack_profile_t *paras = &pack->pack_profiles[key->kp_profile];
+    uint16_t diff = (uint16_t)(now - key->kp_last);
+    bool key_val;
+
+    // 时间锁定消抖: 释放立即生效，按下需距上次状态切换满消抖时间，否则保持原电平
+    if (key->kp_state == KEY_STATE_INIT || !raw || diff >= paras->debounce_time)
+    {
+        key_val = raw;
+    }
+    else
+    {
+        key_val = (key->kp_state == KEY_STATE_PRESSED || key->kp_state == KEY_STATE_LONG_PRESSED ||
+                   key->kp_state == KEY_STATE_LONG_PRESSED_ALWS);
+    }
+
+    bool alws_on = _NN_KEY_ALWS_ON(paras);
+    const nn_key_trans_t *trans;
+    uint8_t hit;
+
+    // 不支持按键选项，没有按住触发长按的截止时刻
+    hit = (uint8_t)(((alws_on && diff >= paras->long_alws_time) << _NN_KEY_CLS_ALWS) |
+                    ((alws_on && diff >= paras->long_time) << _NN_KEY_CLS_STAGE) |
+                    ((diff >= paras->long_time) << _NN_KEY_CLS_LONG) |
+                    ((diff >= paras->multi_time) << _NN_KEY_CLS_MULTI));
+
+    trans = _NN_Key_Transition(key->kp_state, key_val, hit);
+    if (trans->action != _NN_KEY_ACT_STAY) key->kp_state = trans->next;
+
+    switch (trans->action)
+    {
+        case _NN_KEY_ACT_SETTLE:
+            key->kp_last = now;
+            break;
+
+        case _NN_KEY_ACT_PRESS:
+            key->kp_last = now;
+            key->kp_event = KEY_EVENT_INIT;
+            break;
+
+        case _NN_KEY_ACT_LONG_UP:
+        case _NN_KEY_ACT_LONG_END:
+            key->kp_event = KEY_EVENT_LONG_PRESSED;
+            key->kp_last = now;
+            key->kp_count = 0;
+            break;
+
+#if KEY_USE_MULTI
+        case _NN_KEY_ACT_CLICK:
+            key->kp_count++;
+            key->kp_last = now;
+            break;
+
+        case _NN_KEY_ACT_REPRESS:
+            key->kp_last = now;
+            break;
+
+        case _NN_KEY_ACT_MULTI_END:
+            // 根据累计的点击次数设置对应的事件类型
+            if (key->kp_count == 1)
+            {
+                key->kp_event = KEY_EVENT_PRESSED;
+            }
+            else if (key->kp_count == 2)
+            {
+                key->kp_event = KEY_EVENT_DOUBLE_PRESSED;
+            }
+            else if (key->kp_count == 3)
+            {
+                key->kp_event = KEY_EVENT_TRIPLE_PRESSED;
+            }
+            else if (key->kp_count > 3)
+            {
+                key->kp_event = KEY_EVENT_MULTI_PRESSED;
+            }
+
+            key->kp_last = now;
+            key->kp_count = 0;
+            break;
+#else
+        case _NN_KEY_ACT_TAP:
+            key->kp_event = KEY_EVENT_PRESSED;
+            key->kp_last = now;
+            break;
+#endif
+
+#if KEY_USE_LONG_ALWS
+        case _NN_KEY_ACT_ALWS:
+            key->kp_event = KEY_EVENT_LONG_PRESSED_ALWS;
+            key->kp_last = now;
+            break;
+
+        case _NN_KEY_ACT_ALWS_HOLD:
+            key->kp_event = KEY_EVENT_LONG_PRESSED_ALWS;
+            break;
+
+        case _NN_KEY_ACT_ALWS_END:
+#endif
+        case _NN_KEY_ACT_RESET:
+            key->kp_last = now;
+            key->kp_event = KEY_EVENT_INIT;
+            key->kp_count = 0;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 分发紧凑引擎按键事件
+ * @param pack 引擎指针
+ * @param index 按键序号
+ * @param tick 当前系统时钟值(tick)
+ * @note 内部函数，持续长按事件保持并按KEY_LONG_PRESS_ALWS_CB间隔回调，其余事件分发后清除
+ */
+static void _NN_KeyPack_Event(nn_keypack_t *pack, uint16_t index, nn_key_tick_t tick)
+{
+    nn_keypack_key_t *key = &pack->pack_keys[index];
+    const nn_keypack_profile_t *profile = &pack->pack_profiles[key->kp_profile];
+    nn_key_event_t event = (nn_key_event_t)key->kp_event;
+
+    if ((profile->callback_mask & (0x01 << event)) && profile->callback != NULL)
+    {
+#if KEY_USE_LONG_ALWS
+        if (event == KEY_EVENT_LONG_PRESSED_ALWS)
+        {
+            if ((tick - pack->pack_alws_last) >= KEY_MS_TO_TICK(KEY_LONG_PRESS_ALWS_CB))
+            {
+                pack->pack_alws_last = tick;
+                profile->callback(index, event, profile->user_data);
+            }
+            return;
+        }
+#else
+        (void)tick;
+#endif
+
+        profile->callback(index, event, profile->user_data);
+    }
+
+    if (event != KEY_EVENT_LONG_PRESSED_ALWS) key->kp_event = KEY_EVENT_INIT;
+}
+
+/**
+ * @brief 计算紧凑引擎按键的下一个截止时刻
+ * @param pack 引擎指针
+ * @param index 按键序号
+ * @param now 当前时刻(相对基准)
+ * @param raw 按键原始电平(按下为true，释放为false)
+ * @return 电平不变时是否还需运行状态机
+ * @note 内部函数，截止时刻即状态机在电平不变时下一次可能转换的时刻，与_NN_KeyPack_Step的条件对应；
+ *       截止时刻不超过0x7FFF，较远的截止时刻提前到期只会多运行一次状态机
+ */
+static bool _NN_KeyPack_Deadline(nn_keypack_t *pack, uint16_t index, uint16_t now, bool raw)
+{
+    nn_keypack_key_t *key = &pack->pack_keys[index];
+    const nn_keypack_profile_t *paras = &pack->pack_profiles[key->kp_profile];
+    uint32_t due;
+
+    // 有待分发事件(含持续长按)时每次调用都需处理
+    if (key->kp_event != KEY_EVENT_INIT || key->kp_state == KEY_STATE_INIT)
+    {
+        pack->pack_due[index] = now;
+        return true;
+    }
+
+    switch (key->kp_state)
+    {
+        case KEY_STATE_RELEASED:
+            // 按下电平等待消抖
+            if (!raw) return false;
+            due = (uint32_t)key->kp_last + paras->debounce_time;
+            break;
+
+        case KEY_STATE_PRESSED:
+            if (!_NN_KEY_ALWS_ON(paras)) return false;
+            due = (uint32_t)key->kp_last +
+                  ((paras->long_time < paras->long_alws_time) ? paras->long_time : paras->long_alws_time);
+            break;
+
+        case KEY_STATE_LONG_PRESSED:
+            if (!_NN_KEY_ALWS_ON(paras)) return false;
+            due = (uint32_t)key->kp_last + paras->long_alws_time;
+            break;
+
+#if KEY_USE_MULTI
+        case KEY_STATE_MULTI_PRESSED:
+            due = (uint32_t)key->kp_last + paras->multi_time;
+            if (raw && paras->debounce_time < paras->multi_time) due = (uint32_t)key->kp_last + paras->debounce_time;
+            break;
+#endif
+
+        default:
+            due = now;
             break;
     }
+
+    pack->pack_due[index] = (uint16_t)((due > 0x7FFF) ? 0x7FFF : due);
+
+    return true;
+}
+
+/**
+ * @brief 比较32个按键的截止时刻
+ * @param due 截止时刻数组，32项
+ * @param now 当前时刻(相对基准)
+ * @return 到期位图，第i位为1表示due[i] <= now
+ * @note 内部函数，主机上按编译目标使用AVX2或SSE2的无符号饱和减法一次比较16或8项，
+ *       MCU上每个32位字并行比较两项，均无逐项分支
+ */
+static uint32_t _NN_KeyPack_Expired(const uint16_t *due, uint16_t now)
+{
+#if KEY_PACK_SIMD && defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i t = _mm256_set1_epi16((short)now);
+    __m256i lo = _mm256_loadu_si256((const __m256i *)due);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(due + 16));
+
+    // due - now饱和为0即已到期
+    lo = _mm256_cmpeq_epi16(_mm256_subs_epu16(lo, t), zero);
+    hi = _mm256_cmpeq_epi16(_mm256_subs_epu16(hi, t), zero);
+
+    // 打包按128位通道交错，需恢复顺序
+    return (uint32_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+#elif KEY_PACK_SIMD && defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i t = _mm_set1_epi16((short)now);
+    uint32_t mask = 0;
+
+    for (uint8_t i = 0; i < 32; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(due + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(due + i + 8));
+
+        // due - now饱和为0即已到期
+        a = _mm_cmpeq_epi16(_mm_subs_epu16(a, t), zero);
+        b = _mm_cmpeq_epi16(_mm_subs_epu16(b, t), zero);
+        mask |= (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(a, b)) << i;
+    }
+
+    return mask;
+#else
+    // 两项截止时刻均不超过0x7FFF，各自在0x8000 + now上相减不会向高半字借位，第15位即now >= due
+    const uint32_t t = 0x80008000UL | ((uint32_t)now << 16) | now;
+    uint32_t mask = 0;
+
+    for (uint8_t i = 0; i < 32; i += 2)
+    {
+        uint32_t x = t - ((uint32_t)due[i] | ((uint32_t)due[i + 1] << 16));
+        mask |= (((x >> 15) & 1UL) | ((x >> 30) & 2UL)) << i;
+    }
+
+    return mask;
+#endif
 }
\ No newline at end of file
@@ -22,6 +22,7 @@
 /* ========================= 宏定义 ========================= */
 #define KEY_MAX_KEY_NUMBER     20 // 最大按键数量
 #define KEY_MAX_COMBO_NUMBER   20 // 最大组合键数量
+#define KEY_MAX_GROUP_NUMBER   8 // 最大采样分组数量
 
 #define KEY_DEBOUNCE_TIME      20 // 默认消抖时间(ms)
 #define KEY_LONG_PRESS_TIME    500 // 默认长按时间(ms)
@@ -30,10 +31,115 @@
 #define KEY_LONG_PRESS_ALWS_CB 50 // 一直按住的回调函数处理间隔(ms)
 #define KEY_MAX_COMBO_MEMBER   4 // 组合键最多组合成员
 #define KEY_COMBO_WINDOW       300 // 组合键窗口时间(ms)
+#define KEY_DEBOUNCE_SAMPLES   4 // 积分/移位消抖默认采样数
+#define KEY_DEBOUNCE_MARGIN    2 // 自适应消抖时间 = 抖动估计值 * 该倍数
+#define KEY_PORT_WORDS         ((KEY_MAX_KEY_NUMBER + 31) / 32) // 每个端口快照占用的32位字数
+#define KEY_EDGE_FIFO_SIZE     32 // 中断边沿缓冲区大小(必须为2的幂)
+#define KEY_SAMPLE_BUF_SIZE    16 // 采样双缓冲区每个半区的采样数
+#define KEY_CATCHUP_MAX_STEPS  512 // 单次追赶最多结算的截止时刻数
+#define KEY_WHEEL_LEVELS       4 // 超时时间轮层数，每层32格，共覆盖2^(5*层数)个tick，更远的超时到期前会重新放入
+#define KEY_POLL_ACTIVE_MS     10 // 有按键处于手势中时建议的调用间隔(ms)
+#define KEY_POLL_IDLE_MS       200 // 所有按键空闲时建议的调用间隔(ms)
+#define KEY_JITTER_BUCKETS     16 // 调用间隔直方图桶数，最后一桶收纳所有更长的间隔
+#define KEY_JITTER_BUCKET_MS   1 // 调用间隔直方图每桶宽度(ms)
+#ifndef KEY_PACK_SHIFT
+#define KEY_PACK_SHIFT         0 // 紧凑引擎时间单位 = 2^KEY_PACK_SHIFT个tick，时间参数上限为KEY_PACK_TIME_MAX个单位
+#endif
+#ifndef KEY_PACK_SIMD
+#define KEY_PACK_SIMD          1 // 紧凑引擎截止时刻比较是否使用SSE2/AVX2(按编译目标自动选择)，0为使用字并行比较
+#endif
+#ifndef KEY_USE_COMBO
+#define KEY_USE_COMBO          1 // 是否编译组合键功能，为0时去除组合键处理、成员锁定及组合键接口
+#endif
+#ifndef KEY_USE_MULTI
+#define KEY_USE_MULTI          1 // 是否编译连按检测，为0时去除连按状态，短按释放立即产生单击事件
+#endif
+#ifndef KEY_USE_LONG_ALWS
+#define KEY_USE_LONG_ALWS      1 // 是否编译持续长按功能，为0时去除持续长按状态及其重复回调
+#endif
+#ifndef KEY_USE_SECTION
+#define KEY_USE_SECTION        0 // 是否支持通过链接段静态注册按键和组合键(需GCC/Clang及GNU ld兼容链接器)
+#endif
+#ifndef KEY_POOL_KEY_NUMBER
+#define KEY_POOL_KEY_NUMBER    0 // 按键对象池容量，0为不编译按键对象池
+#endif
+#ifndef KEY_POOL_COMBO_NUMBER
+#define KEY_POOL_COMBO_NUMBER  0 // 组合键对象池容量，0为不编译组合键对象池
+#endif
+#ifndef KEY_ID_HASH_SIZE
+#define KEY_ID_HASH_SIZE       0 // ID哈希表槽数，需为2的幂且大于按键和组合键最大数量，0为按ID查找时逐个比较
+#endif
+#ifndef KEY_PRIVATE_CONFIG
+#define KEY_PRIVATE_CONFIG     1 // 按键是否保存私有参数和回调表，为0时按键只能使用配置模板(nn_key_profile_t)以节省RAM
+#endif
+#ifndef KEY_TICK_BITS
+#define KEY_TICK_BITS          32 // 系统时钟位宽(32或64)
+#endif
+#ifndef KEY_TICK_HZ
+#define KEY_TICK_HZ            1000 // 系统时钟频率(每秒计数值)，1000为ms时基，1000000为us时基
+#endif
+
+/* ========================= 时基定义 ========================= */
+#if KEY_TICK_BITS == 64
+typedef uint64_t nn_key_tick_t; // 系统时钟值
+typedef int64_t nn_key_stick_t; // 有符号时钟差
+#else
+typedef uint32_t nn_key_tick_t; // 系统时钟值
+typedef int32_t nn_key_stick_t; // 有符号时钟差
+#endif
+typedef uint32_t nn_key_span_t; // 时间间隔(tick)
+
+/**
+ * ms换算为tick，仅在配置时使用，处理过程中不做单位换算
+ */
+#define KEY_MS_TO_TICK(ms) ((nn_key_span_t)((uint64_t)(ms) * KEY_TICK_HZ / 1000))
+
+/**
+ * tick换算为ms
+ */
+#define KEY_TICK_TO_MS(t) ((uint32_t)((uint64_t)(t) * 1000 / KEY_TICK_HZ))
+
+/**
+ * 时钟a是否早于时钟b (环绕安全)
+ */
+#define KEY_TICK_BEFORE(a, b) ((nn_key_stick_t)((nn_key_tick_t)(a) - (nn_key_tick_t)(b)) < 0)
+
+/**
+ * 紧凑引擎时间参数上限(单位)，时间戳偏移需容纳两倍的时间参数
+ */
+#define KEY_PACK_TIME_MAX 0x3FFF
+
+/**
+ * ms换算为紧凑引擎时间单位，超出16位时饱和为0xFFFF，由NN_KeyPack_Init拒绝
+ */
+#define KEY_PACK_MS(ms) \
+    ((uint16_t)((((uint64_t)(ms) * KEY_TICK_HZ / 1000) >> KEY_PACK_SHIFT) > 0xFFFF ? \
+                    0xFFFF : (((uint64_t)(ms) * KEY_TICK_HZ / 1000) >> KEY_PACK_SHIFT)))
+
+/**
+ * 紧凑引擎位图所需的32位字数(电平位图和定时位图各占一半)
+ */
+#define KEY_PACK_WORDS(n) ((((n) + 31) / 32) * 2)
+
+/**
+ * 紧凑引擎截止时刻数组所需的项数(按32对齐)
+ */
+#define KEY_PACK_DUE_SIZE(n) ((((n) + 31) / 32) * 32)
+
+/**
+ * 完美哈希索引的桶数(扰动值数组项数)
+ */
+#define KEY_PHASH_BUCKETS(n) (((n) + 1) / 2)
+
+/**
+ * 完美哈希索引每个桶的最大表项数
+ */
+#define KEY_PHASH_MAX_BUCKET 8
 
 /* ========================= 类型定义声明 ========================= */
 typedef struct nn_key_t nn_key_t;
 typedef struct nn_comb_t nn_comb_t;
+typedef struct nn_key_group_t nn_key_group_t;
 
 /* ========================= 快捷宏函数 ========================= */
 /**
@@ -61,6 +167,21 @@ typedef struct nn_comb_t nn_comb_t;
  */
 #define NN_Key_SetMultiPressMax(key, max) NN_Key_SetPara(key, 0, 0, 0, 0, max)
 
+/**
+ * 按住达到长按阈值时立即触发长按事件
+ */
+#define NN_Key_EnableLongOnHold(key) NN_Key_SetOpt(key, KEY_OPT_LONG_ON_HOLD, true)
+
+/**
+ * 电平由中断边沿提供
+ */
+#define NN_Key_EnableEdgeSource(key) NN_Key_SetOpt(key, KEY_OPT_EDGE_SOURCE, true)
+
+/**
+ * 释放时立即预发单击事件
+ */
+#define NN_Key_EnableSpeculative(key) NN_Key_SetOpt(key, KEY_OPT_SPECULATIVE, true)
+
 /**
  * @brief 简化按键回调函数定义的宏
  * @param func_name 回调函数名称
@@ -109,6 +230,14 @@ typedef struct nn_comb_t nn_comb_t;
  */
 #define NN_Key_OnMultiClick(key, cb, user_data) NN_Key_SetCb(key, KEY_EVENT_MULTI_PRESSED, cb, user_data)
 
+/**
+ * @brief 快速注册单击撤回事件回调 (仅KEY_OPT_SPECULATIVE模式)
+ * @param key 按键指针
+ * @param cb 回调函数
+ * @param user_data 用户数据
+ */
+#define NN_Key_OnClickRetract(key, cb, user_data) NN_Key_SetCb(key, KEY_EVENT_CLICK_RETRACT, cb, user_data)
+
 /**
  * @brief 快速注册长按事件回调
  * @param key 按键指针
@@ -151,9 +280,35 @@ typedef enum
     KEY_EVENT_DOUBLE_PRESSED, // 双击事件
     KEY_EVENT_TRIPLE_PRESSED, // 三击事件
     KEY_EVENT_MULTI_PRESSED, // 多击事件
+    KEY_EVENT_CLICK_RETRACT, // 撤回已预发的单击事件 (将升级为多击)
     KEY_EVENT_MAX // 最大事件数
 } nn_key_event_t;
 
+/**
+ * @brief 按键选项枚举 (可按位组合)
+ */
+typedef enum
+{
+    KEY_OPT_NONE = 0x00, // 无选项
+    KEY_OPT_LONG_ON_HOLD = 0x01, // 按住达到长按阈值时立即触发长按事件，释放时不再触发
+    KEY_OPT_SPECULATIVE = 0x02, // 释放时立即预发单击，连按窗口内再次按下则发出撤回事件
+    KEY_OPT_ADAPTIVE_DEBOUNCE = 0x04, // 根据实测抖动自动调整消抖时间 (由NN_Key_SetAdaptiveDebounce开启)
+    KEY_OPT_EDGE_SOURCE = 0x08, // 电平来自中断边沿(NN_Key_PushEdge)，处理函数不再调用读取函数
+} nn_key_opt_t;
+
+/**
+ * @brief 消抖策略枚举
+ * @note 各策略每次采样的开销均为O(1)，按延迟与抗误触需求为每个按键选择
+ */
+typedef enum
+{
+    KEY_DEBOUNCE_LOCKOUT = 0, // 时间锁定(默认): 距上次状态切换满消抖时间才接受按下，释放立即生效; 开销: 1次减法+1次比较
+    KEY_DEBOUNCE_EAGER, // 抢先: 任一跳变立即上报，随后消抖时间内忽略抖动; 开销: 1次减法+1次比较
+    KEY_DEBOUNCE_INTEGRATOR, // 计数积分: 按下计数加1、释放减1，计满/归零才翻转; 开销: 1次加减+2次比较
+    KEY_DEBOUNCE_SHIFT, // 移位寄存器: 最近N次采样全部一致才翻转(N<=16); 开销: 1次移位+2次掩码比较
+    KEY_DEBOUNCE_ASYMMETRIC, // 非对称: 电平保持消抖时间才确认按下，保持释放消抖时间才确认释放; 开销: 2次减法+2次比较
+} nn_key_debounce_t;
+
 /* ========================= 函数定义 ========================= */
 /**
  * @brief 按键读取函数类型定义
@@ -191,41 +346,146 @@ typedef struct
 } nn_key_callback_item_t;
 
 /**
- * @brief 按键数据结构定义
+ * @brief 按键时间参数结构体
+ * @note 配置时已换算为tick
  */
-typedef struct nn_key_t
+typedef struct
+{
+    nn_key_span_t debounce_time; // 消抖时间(tick)，应用模板时复制给按键
+    nn_key_span_t long_time; // 长按时间阈值(tick)
+    nn_key_span_t long_alws_time; // 持续长按时间阈值(tick)
+    nn_key_span_t multi_time; // 连按间隔时间(tick)
+} nn_key_paras_t;
+
+/**
+ * @brief 按键配置模板
+ * @note 多个按键可共享同一模板的参数和回调表，模板可声明为const放在Flash中，
+ *       修改模板对所有使用它的按键立即生效
+ */
+typedef struct nn_key_profile_t
+{
+    const char *profile_id; // 模板标识符
+    nn_key_paras_t key_paras; // 参数结构体
+    uint8_t multi_max; // 最大连按次数
+    uint8_t callback_mask; // 回调位掩码，每位表示一个事件是否有回调函数
+    nn_key_callback_item_t callbacks[KEY_EVENT_MAX]; // 各事件的回调函数和用户数据
+} nn_key_profile_t;
+
+/**
+ * @brief 按键描述表项
+ * @note 用于NN_Key_AddTable，整张表可声明为const放在Flash中
+ */
+typedef struct
 {
     const char *key_id; // 按键标识符
     nn_key_read_t key_read; // 按键读取函数
-    uint32_t key_last_time; // 上次处理时间
+    const nn_key_profile_t *key_profile; // 配置模板，NULL表示默认参数且无回调
+} nn_key_desc_t;
 
-    struct
-    {
-        uint16_t debounce_time; // 消抖时间
-        uint16_t long_time; // 长按时间阈值
-        uint16_t long_alws_time; // 持续长按时间阈值
-        uint16_t multi_time; // 连按间隔时间
-    } key_paras; // 参数结构体
+/**
+ * @brief 按键描述表的最小完美哈希索引
+ * @note 由NN_Key_PhashBuild生成，扰动值和映射数组生成后可导出为const数组，
+ *       之后直接静态初始化本结构体，无需在启动时再次生成
+ */
+typedef struct
+{
+    const nn_key_desc_t *table; // 按键描述表
+    nn_key_t *keys; // 与描述表一一对应的按键数组
+    const uint16_t *disp; // 各桶的扰动值，项数为KEY_PHASH_BUCKETS(count)
+    const uint8_t *slot; // 哈希位置到表项序号的映射，项数为count
+    uint8_t count; // 表项数
+} nn_key_phash_t;
+
+/**
+ * @brief 超时定时器节点
+ * @note 嵌入在按键和组合键结构体中，由内部时间轮管理，用户无需访问
+ */
+typedef struct nn_key_timer_t
+{
+    struct nn_key_timer_t *next; // 同一格的下一个节点
+    struct nn_key_timer_t *prev; // 同一格的上一个节点
+    nn_key_tick_t expire; // 到期时刻
+    uint8_t index; // 所属按键或组合键的序号
+    uint8_t slot; // 所在的格(层*32+格序号)
+    bool is_combo:1; // 是否属于组合键
+    bool linked:1; // 是否已在时间轮中
+} nn_key_timer_t;
+
+/**
+ * @brief 按键运行数据结构定义
+ * @note 处理函数每次都要访问的状态和参数，所有按键的运行数据集中存放在库内部的连续数组中，
+ *       按键添加时分配，用户无需访问
+ */
+typedef struct nn_key_core_t
+{
+    nn_key_tick_t key_last_time; // 上次处理时间
+    nn_key_tick_t key_deadline; // 长按截止时间 (按下时预先计算)
 
     struct
     {
         nn_key_state_t state:3; // 当前按键状态 (使用位域)
-        nn_key_event_t event:3; // 当前按键事件 (使用位域)
+        nn_key_event_t event:4; // 当前按键事件 (使用位域)
         bool is_member:1; // 是一个组合键的成员
         bool lock_flag:1; // 保留位
     } key_flags; // 标志位结构体
 
     struct
     {
-        uint8_t multi_max:4; // 最大连按次数 (使用位域)
         uint8_t multi_count:4; // 当前连按次数 (使用位域)
     } key_multi_paras; // 多击相关
 
-    // 回调位掩码，每位表示一个事件是否有回调函数
-    uint8_t callback_mask;
+    // 按键选项位掩码，见nn_key_opt_t
+    uint8_t key_opts;
+
+    // 手势序号，同一次按键手势产生的所有事件序号相同
+    uint8_t key_seq;
+
+    // 配置模板，时间参数和回调表均从此读取
+    const nn_key_profile_t *key_profile;
+
+    struct
+    {
+        nn_key_debounce_t mode:3; // 消抖策略
+        nn_key_span_t press_time; // 按下消抖时间(tick)，自适应消抖会调整
+        bool level:1; // 消抖后的稳定电平
+        bool raw:1; // 上一次采样的原始电平
+        bool measuring:1; // 正在测量稳定跳变后的抖动
+        uint8_t count; // 积分计数器
+        uint16_t history; // 移位寄存器
+        nn_key_tick_t stable_time; // 稳定电平上次跳变时间
+        nn_key_tick_t raw_time; // 原始电平上次跳变时间
+    } key_debounce; // 消抖状态
+} nn_key_core_t;
+
+/**
+ * @brief 按键数据结构定义
+ * @note 只保存配置和回调等不常访问的数据，运行数据见nn_key_core_t
+ */
+typedef struct nn_key_t
+{
+    nn_key_core_t *key_core; // 运行数据
+    nn_key_read_t key_read; // 按键读取函数
+    const char *key_id; // 按键标识符
+    nn_key_timer_t key_timer; // 下一个截止时刻的定时器
+
+    // 所属采样分组，NULL表示每次调用处理函数都采样
+    nn_key_group_t *key_group;
 
-    // 为每个事件类型分配独立的回调函数和用户数据
-    nn_key_callback_item_t callbacks[KEY_EVENT_MAX];
+    // 消抖的策略参数和自适应调优数据，只有部分策略在采样时访问，不放在运行数据中
+    struct
+    {
+        uint8_t samples; // 积分/移位策略的采样数
+        nn_key_span_t release_time; // 释放消抖时间(tick) (非对称策略)
+        nn_key_span_t bounce_obs; // 本次测量到的抖动时长(tick)
+        nn_key_span_t bounce_est; // 抖动时长估计值(1/16 tick)
+        nn_key_span_t adapt_min; // 自适应消抖时间下限(tick)
+        nn_key_span_t adapt_max; // 自适应消抖时间上限(tick)，同时也是抖动测量窗口
+    } key_tune;
+
+#if KEY_PRIVATE_CONFIG
+    // 私有配置，未使用共享模板时运行数据指向它
+    nn_key_profile_t key_own;
+#endif
 } nn_key_t;
 
 /**
@@ -251,33 +511,258 @@ typedef struct nn_comb_t
     } combo_value;
 #endif
 
-    uint32_t combo_mem_first; // 成员第一次按下的时间
-    uint16_t combo_window; // 窗口时间
+    nn_key_tick_t combo_mem_first; // 成员第一次按下的时间
+    nn_key_span_t combo_window; // 窗口时间(tick)
     uint8_t combo_member_nbr; // 成员数目
+    bool combo_open; // 窗口是否已打开
     bool combo_trigger; // 是否触发
+    nn_key_timer_t combo_timer; // 窗口超时定时器
     nn_key_t *combo_member[KEY_MAX_COMBO_MEMBER]; // 组合键成员指针数组
     nn_key_callback_item_t combo_cb; // 组合键的回调函数
 } nn_comb_t;
 
+/**
+ * @brief 采样分组数据结构定义
+ * @note 同组按键共用一个采样周期，未到期的分组在处理函数中既不读取也不运行状态机
+ */
+typedef struct nn_key_group_t
+{
+    const char *group_id; // 分组标识符
+    nn_key_span_t group_period; // 采样周期(tick)
+    nn_key_tick_t group_next; // 下次采样时刻
+    bool group_started; // 是否已采样过
+    bool group_due; // 本次调用是否到期
+} nn_key_group_t;
+
+/**
+ * @brief 处理函数调用间隔统计
+ */
+typedef struct
+{
+    uint32_t count; // 统计的间隔个数
+    nn_key_span_t min; // 最短间隔(tick)
+    nn_key_span_t max; // 最长间隔(tick)
+    nn_key_span_t last; // 最近一次间隔(tick)
+} nn_key_jitter_t;
+
+/**
+ * @brief 紧凑引擎回调函数类型定义
+ * @param index 按键序号
+ * @param event 按键事件类型
+ * @param user_data 用户数据指针
+ */
+typedef void (*nn_keypack_callback_t)(uint16_t index, nn_key_event_t event, void *user_data);
+
+/**
+ * @brief 紧凑引擎配置模板
+ * @note 时间参数以2^KEY_PACK_SHIFT个tick为单位，可用KEY_PACK_MS换算，不超过KEY_PACK_TIME_MAX，可声明为const放在Flash中
+ */
+typedef struct
+{
+    uint16_t debounce_time; // 消抖时间
+    uint16_t long_time; // 长按时间阈值
+    uint16_t long_alws_time; // 持续长按时间阈值，0为关闭
+    uint16_t multi_time; // 连按间隔时间
+    uint16_t callback_mask; // 回调位掩码，每位表示一个事件是否回调
+    nn_keypack_callback_t callback; // 回调函数
+    void *user_data; // 用户数据指针
+} nn_keypack_profile_t;
+
+/**
+ * @brief 紧凑引擎按键状态
+ * @note 每个按键4字节，时间戳为相对引擎基准时刻的偏移
+ */
+typedef struct
+{
+    uint16_t kp_last; // 上次状态切换时刻(相对基准)
+    uint16_t kp_state:3; // 当前按键状态
+    uint16_t kp_event:4; // 待分发的按键事件
+    uint16_t kp_count:4; // 当前连按次数
+    uint16_t kp_profile:4; // 配置模板序号
+} nn_keypack_key_t;
+
+/**
+ * @brief 紧凑引擎数据结构定义
+ * @note 一个引擎即一个共用时间基准的按键分组，所有存储由调用者提供
+ *       截止时刻单独存放在连续数组中，每次调用按32个按键一组并行比较得到到期位图
+ */
+typedef struct
+{
+    nn_keypack_key_t *pack_keys; // 按键状态数组
+    uint16_t *pack_due; // 各按键下一个截止时刻(相对基准)
+    uint32_t *pack_last; // 上一次采样的电平位图
+    uint32_t *pack_busy; // 有截止时刻的按键位图，电平不变时只在截止时刻运行状态机
+    const nn_keypack_profile_t *pack_profiles; // 配置模板数组
+    uint16_t pack_num; // 按键数量
+    uint8_t pack_profile_num; // 配置模板数量
+    nn_key_tick_t pack_epoch; // 时间基准
+    nn_key_tick_t pack_alws_last; // 上次持续长按回调的时间
+} nn_keypack_t;
+
+/* ========================= 静态注册 ========================= */
+#if KEY_USE_SECTION
+/**
+ * @brief 按键静态注册项
+ * @note 由NN_KEY_REGISTER生成并放在nn_key_reg段中，用户无需直接访问
+ */
+typedef struct
+{
+    nn_key_t *key; // 按键
+    nn_key_desc_t desc; // 按键描述
+} nn_key_reg_t;
+
+#if KEY_USE_COMBO
+/**
+ * @brief 组合键静态注册项
+ * @note 由NN_COMBO_REGISTER生成并放在nn_comb_reg段中，用户无需直接访问
+ */
+typedef struct
+{
+    nn_comb_t *comb; // 组合键
+    const char *combo_id; // 组合键标识符
+    nn_key_t *const *members; // 成员按键数组
+    uint8_t member_num; // 成员数目
+    nn_comb_callback_t cb; // 回调函数，可为NULL
+    void *user_data; // 用户数据指针
+} nn_comb_reg_t;
+#endif
+
+/**
+ * 注册项的段属性，显式对齐保证段内注册项可按数组遍历
+ */
+#define _NN_KEY_SECTION(sec) __attribute__((used, section(sec), aligned(sizeof(void *))))
+
+/**
+ * @brief 定义并静态注册一个按键
+ * @param name 按键变量名
+ * @param id 按键标识符
+ * @param read_func 按键读取函数
+ * @param profile 配置模板指针，NULL表示默认参数且无回调
+ * @details 在任意源文件的文件作用域使用，首次调用处理函数时自动添加，无需在初始化函数中调用
+ *          例如: NN_KEY_REGISTER(KeyUp, "up", ReadUp, &panel_profile);
+ */
+#define NN_KEY_REGISTER(name, id, read_func, profile) \
+    nn_key_t name;                                    \
+    static const nn_key_reg_t _nn_key_reg_##name _NN_KEY_SECTION("nn_key_reg") = {&name, {id, read_func, profile}}
+
+/**
+ * @brief 声明在其他源文件中静态注册的按键
+ * @param name 按键变量名
+ */
+#define NN_KEY_DECLARE(name) extern nn_key_t name
+
+#if KEY_USE_COMBO
+/**
+ * @brief 定义并静态注册一个组合键
+ * @param name 组合键变量名
+ * @param id 组合键标识符
+ * @param cb 回调函数，可为NULL
+ * @param user_data 用户数据指针
+ * @param ... 成员按键指针(2~KEY_MAX_COMBO_MEMBER个)
+ * @details 组合键在所有静态注册的按键之后添加
+ *          例如: NN_COMBO_REGISTER(ComboUpDown, "up+down", OnUpDown, NULL, &KeyUp, &KeyDown);
+ */
+#define NN_COMBO_REGISTER(name, id, cb, user_data, ...)                                                 \
+    nn_comb_t name;                                                                                     \
+    static nn_key_t *const _nn_comb_mem_##name[] = {__VA_ARGS__};                                       \
+    static const nn_comb_reg_t _nn_comb_reg_##name _NN_KEY_SECTION("nn_comb_reg") = {                   \
+        &name, id, _nn_comb_mem_##name, sizeof(_nn_comb_mem_##name) / sizeof(_nn_comb_mem_##name[0]), cb, \
+        user_data}
+#endif
+#endif
+
 /* ========================= 函数声明 ========================= */
 /* --- 基础按键操作函数 --- */
 bool NN_Key_Init(nn_key_t *key, const char *name, nn_key_read_t pfunc);
 bool NN_Key_Add(nn_key_t *key, const char *id, nn_key_read_t read_func);
+bool NN_Key_AddTable(nn_key_t *keys, const nn_key_desc_t *table, uint8_t count);
+#if KEY_USE_SECTION
+bool NN_Key_RegisterAll(void);
+#endif
+bool NN_Key_Remove(nn_key_t *key);
 bool NN_Key_SetPara(nn_key_t *key,
                     uint16_t debounce_time,
                     uint16_t long_time,
                     uint16_t long_alws_time,
                     uint16_t multi_time,
                     uint8_t multi_max);
-bool NN_Key_Handler(uint32_t tick);
+bool NN_Key_SetParaTick(nn_key_t *key,
+                        nn_key_span_t debounce_time,
+                        nn_key_span_t long_time,
+                        nn_key_span_t long_alws_time,
+                        nn_key_span_t multi_time);
+bool NN_Key_SetOpt(nn_key_t *key, nn_key_opt_t opt, bool enable);
+bool NN_Key_SetDebounce(nn_key_t *key, nn_key_debounce_t mode, uint16_t press_para, uint16_t release_para);
+bool NN_Key_SetAdaptiveDebounce(nn_key_t *key, uint16_t min_time, uint16_t max_time);
+uint16_t NN_Key_GetDebounceTime(nn_key_t *key);
+uint8_t NN_Key_GetSeq(nn_key_t *key);
+int16_t NN_Key_GetIndex(nn_key_t *key);
+nn_key_t *NN_Key_Find(const char *id);
+bool NN_Key_PhashBuild(nn_key_phash_t *ph, nn_key_t *keys, const nn_key_desc_t *table, uint8_t count, uint16_t *disp, uint8_t *slot);
+nn_key_t *NN_Key_PhashFind(const nn_key_phash_t *ph, const char *id);
+bool NN_Key_ProfileInit(nn_key_profile_t *profile, const char *id);
+bool NN_Key_ProfileSetPara(nn_key_profile_t *profile,
+                           uint16_t debounce_time,
+                           uint16_t long_time,
+                           uint16_t long_alws_time,
+                           uint16_t multi_time,
+                           uint8_t multi_max);
+bool NN_Key_ProfileSetCb(nn_key_profile_t *profile, nn_key_event_t event, nn_key_callback_t cb, void *user_data);
+bool NN_Key_ProfileDeleteCb(nn_key_profile_t *profile, nn_key_event_t event);
+bool NN_Key_SetProfile(nn_key_t *key, const nn_key_profile_t *profile);
+bool NN_Key_GroupAdd(nn_key_group_t *group, const char *id, uint16_t period_ms);
+bool NN_Key_GroupSetPeriod(nn_key_group_t *group, uint16_t period_ms);
+bool NN_Key_SetGroup(nn_key_t *key, nn_key_group_t *group);
+bool NN_Key_Handler(nn_key_tick_t tick);
+nn_key_span_t NN_Key_HandlerAdaptive(nn_key_tick_t tick, bool *idle);
+nn_key_span_t NN_Key_PollInterval(nn_key_tick_t tick, bool *idle);
+bool NN_Key_HandlerBudget(nn_key_tick_t tick, uint8_t budget);
+bool NN_Key_SetBudgetLatency(uint8_t calls);
+uint8_t NN_Key_GetBudgetLeast(void);
+bool NN_Key_HandlerBlock(const uint32_t *ports, const nn_key_tick_t *ticks, uint16_t count);
+bool NN_Key_HandlerMask(nn_key_tick_t tick, const uint32_t *dirty);
+bool NN_Key_SampleISR(nn_key_tick_t tick);
+bool NN_Key_Process(void);
+bool NN_Key_PushEdge(uint8_t index, bool level, nn_key_tick_t tick);
+bool NN_Key_CatchUp(nn_key_tick_t tick);
+bool NN_Key_SetCatchUpGap(uint16_t gap_ms);
+bool NN_Key_GetJitter(nn_key_jitter_t *stat);
+nn_key_span_t NN_Key_GetJitterPercentile(uint8_t percent);
+bool NN_Key_ResetJitter(void);
+bool NN_Key_SetJitterComp(bool enable);
 
 /* --- 按键回调函数管理 --- */
 bool NN_Key_SetCb(nn_key_t *key, nn_key_event_t event, nn_key_callback_t cb, void *user_data);
 bool NN_Key_DeleteCb(nn_key_t *key, nn_key_event_t event);
 
 /* --- 组合按键管理函数 --- */
+#if KEY_USE_COMBO
 bool NN_Combo_Add(nn_comb_t *comb, const char *id, uint8_t mem_nbr, nn_key_t *member1, nn_key_t *member2, ...);
 bool NN_Combo_SetCb(nn_comb_t *combo, nn_comb_callback_t cb, void *para);
 bool NN_Combo_SetWindowTime(nn_comb_t *combo, uint16_t time_ms);
+bool NN_Combo_Remove(nn_comb_t *comb);
+nn_comb_t *NN_Combo_Find(const char *id);
+#endif
+
+/* --- 对象池 --- */
+#if KEY_POOL_KEY_NUMBER > 0
+nn_key_t *NN_Key_Create(const char *id, nn_key_read_t read_func);
+bool NN_Key_Destroy(nn_key_t *key);
+#endif
+#if KEY_USE_COMBO && KEY_POOL_COMBO_NUMBER > 0
+nn_comb_t *NN_Combo_Create(const char *id, uint8_t mem_nbr, nn_key_t *member1, nn_key_t *member2, ...);
+bool NN_Combo_Destroy(nn_comb_t *comb);
+#endif
+
+/* --- 紧凑按键引擎 --- */
+bool NN_KeyPack_Init(nn_keypack_t *pack,
+                     nn_keypack_key_t *keys,
+                     uint16_t *due,
+                     uint32_t *words,
+                     uint16_t key_num,
+                     const nn_keypack_profile_t *profiles,
+                     uint8_t profile_num);
+bool NN_KeyPack_SetProfile(nn_keypack_t *pack, uint16_t index, uint8_t profile);
+bool NN_KeyPack_Handler(nn_keypack_t *pack, nn_key_tick_t tick, const uint32_t *ports);
 
 #endif
@@ -0,0 +1,373 @@
+/**
+ * @file test_key.c
+ * @brief 按键状态机回归与差分测试
+ * @details 用伪随机按键轨迹驱动库，检查:
+ *          1. 主引擎的事件序列与表驱动状态机改写前的实现一致(事件序列哈希与基准值比较)
+ *          2. 紧凑引擎与主引擎在相同参数下的事件序列一致
+ *          库使用全局按键列表，每个场景在单独的进程中运行，由Makefile逐个调用
+ *          用法: test_key golden <场景号> | test_key pack <种子> <调用步长> | test_key gen <场景号>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NN_Key.h"
+
+/* ========================= 宏定义 ========================= */
+#define TEST_KEY_NUM  8 // 参与测试的按键数
+#define TEST_TICKS    60000 // 每个场景的轨迹长度(tick)
+#define TEST_LOG_SIZE 8192 // 差分测试每个引擎最多记录的事件数
+
+/* ========================= 类型定义 ========================= */
+/**
+ * @brief 基准场景
+ */
+typedef struct
+{
+    uint32_t seed; // 轨迹种子
+    uint8_t max_step; // 处理函数调用间隔上限(tick)，实际间隔在1~max_step之间随机
+    uint8_t bounce; // 每次按下开头的抖动长度(tick)
+    bool combo; // 是否添加组合键
+    uint32_t hash; // 事件序列哈希基准值
+    uint32_t count; // 事件数基准值
+} test_golden_t;
+
+/**
+ * @brief 事件记录
+ */
+typedef struct
+{
+    uint32_t tick; // 事件时刻
+    uint8_t index; // 按键序号
+    uint8_t event; // 事件类型
+} test_log_t;
+
+/* ========================= 全局变量定义 ========================= */
+// 基准值由表驱动状态机改写前的实现生成，状态机语义有意变更时用gen重新生成
+static const test_golden_t test_golden[] = {
+    {1, 1, 0, false, 0xC3BFB3ECUL, 1328},
+    {1, 1, 0, true, 0x1A9CC882UL, 1207},
+    {1, 1, 8, false, 0x7075716DUL, 1408},
+    {1, 1, 8, true, 0x69953008UL, 1262},
+    {1, 10, 0, false, 0x0ED955F9UL, 1263},
+    {1, 10, 0, true, 0xE2E36BB5UL, 1147},
+    {1, 10, 8, false, 0x80754F9BUL, 1300},
+    {1, 10, 8, true, 0xA7545716UL, 1149},
+    {1, 25, 0, false, 0xAE1523BFUL, 1165},
+    {1, 25, 0, true, 0x57F52D1FUL, 1059},
+    {1, 25, 8, false, 0xECE9D745UL, 1202},
+    {1, 25, 8, true, 0x368120E3UL, 1064},
+    {2, 1, 0, false, 0x89398812UL, 1345},
+    {2, 1, 0, true, 0xED8BE3B1UL, 1183},
+    {2, 1, 8, false, 0x0954E9F7UL, 1341},
+    {2, 1, 8, true, 0x0D40284AUL, 1213},
+    {2, 10, 0, false, 0x72D85CA0UL, 1284},
+    {2, 10, 0, true, 0x892A401EUL, 1128},
+    {2, 10, 8, false, 0x61CC4BCFUL, 1252},
+    {2, 10, 8, true, 0xBA0BBEC4UL, 1124},
+    {2, 25, 0, false, 0x32ED8012UL, 1187},
+    {2, 25, 0, true, 0xC37542EFUL, 1050},
+    {2, 25, 8, false, 0xE5F493E3UL, 1161},
+    {2, 25, 8, true, 0x7681E7F0UL, 1044},
+};
+
+static uint8_t test_level[TEST_KEY_NUM][TEST_TICKS]; // 按键电平轨迹
+static uint32_t test_now; // 当前时刻
+static uint32_t test_rand_state; // 伪随机数状态
+static uint32_t test_hash; // 事件序列哈希
+static uint32_t test_count; // 事件数
+static nn_key_t test_keys[TEST_KEY_NUM];
+static char test_names[TEST_KEY_NUM][4];
+#if KEY_USE_COMBO
+static nn_comb_t test_combos[2];
+#endif
+
+static test_log_t test_log_main[TEST_LOG_SIZE]; // 主引擎事件记录
+static test_log_t test_log_pack[TEST_LOG_SIZE]; // 紧凑引擎事件记录
+static uint32_t test_log_main_num;
+static uint32_t test_log_pack_num;
+
+/* ========================= 轨迹生成 ========================= */
+/**
+ * @brief 伪随机数(xorshift32)
+ * @return 随机数
+ */
+static uint32_t Test_Rand(void)
+{
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+
+    return test_rand_state;
+}
+
+/**
+ * @brief 生成按键电平轨迹
+ * @param seed 种子
+ * @param bounce 每次按下开头的抖动长度(tick)
+ * @note 空闲、短按、长按和持续长按随机交替，短按间隔较短时形成连按
+ */
+static void Test_Trace(uint32_t seed, uint8_t bounce)
+{
+    test_rand_state = seed;
+
+    for (uint8_t k = 0; k < TEST_KEY_NUM; k++)
+    {
+        uint32_t t = 0;
+
+        while (t < TEST_TICKS)
+        {
+            uint32_t idle = Test_Rand() % 800;
+            uint32_t kind = Test_Rand() % 10;
+            uint32_t hold = kind < 6 ? 20 + Test_Rand() % 250 : kind < 8 ? 400 + Test_Rand() % 1200 : 1400 + Test_Rand() % 3000;
+
+            for (uint32_t i = 0; i < idle && t < TEST_TICKS; i++) test_level[k][t++] = 0;
+            for (uint32_t i = 0; i < hold && t < TEST_TICKS; i++) test_level[k][t++] = (i < bounce) ? (Test_Rand() & 1) : 1;
+        }
+    }
+}
+
+#define TEST_READ(n) \
+    static bool Test_Read##n(void) { return test_level[n][test_now]; }
+TEST_READ(0)
+TEST_READ(1)
+TEST_READ(2)
+TEST_READ(3)
+TEST_READ(4)
+TEST_READ(5)
+TEST_READ(6)
+TEST_READ(7)
+static const nn_key_read_t test_read[TEST_KEY_NUM] = {Test_Read0, Test_Read1, Test_Read2, Test_Read3,
+                                                      Test_Read4, Test_Read5, Test_Read6, Test_Read7};
+
+/* ========================= 事件记录 ========================= */
+/**
+ * @brief 把一个事件计入哈希(FNV-1a)
+ * @param tick 事件时刻
+ * @param index 按键序号，组合键为0x80+序号
+ * @param event 事件类型
+ */
+static void Test_Hash(uint32_t tick, uint8_t index, uint8_t event)
+{
+    uint8_t bytes[6] = {(uint8_t)tick, (uint8_t)(tick >> 8), (uint8_t)(tick >> 16), (uint8_t)(tick >> 24), index, event};
+
+    for (uint8_t i = 0; i < sizeof(bytes); i++)
+    {
+        test_hash ^= bytes[i];
+        test_hash *= 16777619UL;
+    }
+    test_count++;
+}
+
+static NN_KEY_CALLBACK(Test_KeyHash)
+{
+    (void)user_data;
+    Test_Hash(test_now, (uint8_t)(key - test_keys), (uint8_t)event);
+}
+
+#if KEY_USE_COMBO
+static NN_COMB_CALLBACK(Test_CombHash)
+{
+    (void)user_data;
+    Test_Hash(test_now, (uint8_t)(0x80 + (comb - test_combos)), 0);
+}
+#endif
+
+static NN_KEY_CALLBACK(Test_KeyLog)
+{
+    (void)user_data;
+    if (test_log_main_num < TEST_LOG_SIZE)
+    {
+        test_log_main[test_log_main_num++] = (test_log_t){test_now, (uint8_t)(key - test_keys), (uint8_t)event};
+    }
+}
+
+static void Test_PackLog(uint16_t index, nn_key_event_t event, void *user_data)
+{
+    (void)user_data;
+    if (test_log_pack_num < TEST_LOG_SIZE)
+    {
+        test_log_pack[test_log_pack_num++] = (test_log_t){test_now, (uint8_t)index, (uint8_t)event};
+    }
+}
+
+/* ========================= 测试场景 ========================= */
+/**
+ * @brief 运行一个基准场景
+ * @param golden 场景参数
+ * @note 按键覆盖默认配置、长按和连按参数、按住即长按、预发单击及各种消抖策略
+ */
+static void Test_GoldenRun(const test_golden_t *golden)
+{
+    Test_Trace(golden->seed, golden->bounce);
+    test_hash = 2166136261UL;
+    test_count = 0;
+
+    for (uint8_t k = 0; k < TEST_KEY_NUM; k++)
+    {
+        sprintf(test_names[k], "K%u", k);
+        NN_Key_Add(&test_keys[k], test_names[k], test_read[k]);
+        for (uint8_t e = KEY_EVENT_PRESSED; e < KEY_EVENT_MAX; e++)
+        {
+            NN_Key_SetCb(&test_keys[k], (nn_key_event_t)e, Test_KeyHash, NULL);
+        }
+    }
+
+    NN_Key_SetPara(&test_keys[1], 0, 800, 0, 200, 0);
+    NN_Key_SetOpt(&test_keys[2], KEY_OPT_LONG_ON_HOLD, true);
+    NN_Key_SetOpt(&test_keys[3], KEY_OPT_SPECULATIVE, true);
+    NN_Key_SetPara(&test_keys[4], 0, 300, 900, 250, 5);
+    NN_Key_SetDebounce(&test_keys[5], KEY_DEBOUNCE_EAGER, 15, 0);
+    NN_Key_SetDebounce(&test_keys[6], KEY_DEBOUNCE_INTEGRATOR, 4, 0);
+    NN_Key_SetDebounce(&test_keys[7], KEY_DEBOUNCE_ASYMMETRIC, 20, 40);
+    NN_Key_SetOpt(&test_keys[7], KEY_OPT_SPECULATIVE, true);
+    NN_Key_SetOpt(&test_keys[7], KEY_OPT_LONG_ON_HOLD, true);
+
+#if KEY_USE_COMBO
+    if (golden->combo)
+    {
+        // 成员按键跟随第一个成员错开几个tick按下，使组合键能够触发
+        for (uint32_t t = TEST_TICKS - 1; t >= 12; t--)
+        {
+            test_level[1][t] = test_level[0][t - 7];
+            test_level[3][t] = test_level[2][t - 12];
+            test_level[4][t] = (t & 0x4000) ? test_level[4][t] : test_level[2][t - 3];
+        }
+
+        NN_Combo_Add(&test_combos[0], "C01", 2, &test_keys[0], &test_keys[1]);
+        NN_Combo_Add(&test_combos[1], "C234", 3, &test_keys[2], &test_keys[3], &test_keys[4]);
+        NN_Combo_SetCb(&test_combos[0], Test_CombHash, NULL);
+        NN_Combo_SetCb(&test_combos[1], Test_CombHash, NULL);
+    }
+#endif
+
+    for (test_now = 1; test_now < TEST_TICKS; test_now += 1 + Test_Rand() % golden->max_step)
+    {
+        NN_Key_Handler(test_now);
+    }
+}
+
+/**
+ * @brief 紧凑引擎与主引擎差分测试
+ * @param seed 轨迹种子
+ * @param step 调用步长(tick)
+ * @return 两个引擎的事件序列是否一致
+ * @note 主引擎使用默认的时间锁定消抖，与紧凑引擎语义相同；奇数号按键使用第二套参数
+ */
+static bool Test_PackRun(uint32_t seed, uint8_t step)
+{
+    static nn_keypack_t pack;
+    static nn_keypack_key_t pack_keys[TEST_KEY_NUM];
+    static uint16_t pack_due[KEY_PACK_DUE_SIZE(TEST_KEY_NUM)];
+    static uint32_t pack_words[KEY_PACK_WORDS(TEST_KEY_NUM)];
+    nn_keypack_profile_t profiles[2];
+
+    Test_Trace(seed, 6);
+
+    profiles[0].debounce_time = KEY_PACK_MS(KEY_DEBOUNCE_TIME);
+    profiles[0].long_time = KEY_PACK_MS(KEY_LONG_PRESS_TIME);
+    profiles[0].long_alws_time = KEY_PACK_MS(KEY_LONG_PRESS_ALWS);
+    profiles[0].multi_time = KEY_PACK_MS(KEY_MULTI_PRESS_TIME);
+    profiles[0].callback_mask = 0xFFFF;
+    profiles[0].callback = Test_PackLog;
+    profiles[0].user_data = NULL;
+    profiles[1] = profiles[0];
+    profiles[1].long_time = KEY_PACK_MS(800);
+    profiles[1].multi_time = KEY_PACK_MS(200);
+
+    if (!NN_KeyPack_Init(&pack, pack_keys, pack_due, pack_words, TEST_KEY_NUM, profiles, 2)) return false;
+
+    for (uint8_t k = 0; k < TEST_KEY_NUM; k++)
+    {
+        sprintf(test_names[k], "K%u", k);
+        NN_Key_Add(&test_keys[k], test_names[k], test_read[k]);
+        for (uint8_t e = KEY_EVENT_PRESSED; e < KEY_EVENT_MAX; e++)
+        {
+            NN_Key_SetCb(&test_keys[k], (nn_key_event_t)e, Test_KeyLog, NULL);
+        }
+        if (k & 1)
+        {
+            NN_Key_SetPara(&test_keys[k], 0, 800, 0, 200, 0);
+            NN_KeyPack_SetProfile(&pack, k, 1);
+        }
+    }
+
+    for (test_now = 1; test_now < TEST_TICKS; test_now += step)
+    {
+        uint32_t ports = 0;
+
+        for (uint8_t k = 0; k < TEST_KEY_NUM; k++) ports |= (uint32_t)test_level[k][test_now] << k;
+
+        NN_Key_Handler(test_now);
+        NN_KeyPack_Handler(&pack, test_now, &ports);
+    }
+
+    // 同一时刻不同按键的事件顺序不作要求，逐按键比较
+    for (uint8_t k = 0; k < TEST_KEY_NUM; k++)
+    {
+        uint32_t i = 0;
+        uint32_t j = 0;
+
+        for (;;)
+        {
+            while (i < test_log_main_num && test_log_main[i].index != k) i++;
+            while (j < test_log_pack_num && test_log_pack[j].index != k) j++;
+            if (i >= test_log_main_num || j >= test_log_pack_num) break;
+            if (test_log_main[i].tick != test_log_pack[j].tick || test_log_main[i].event != test_log_pack[j].event)
+            {
+                printf("pack seed=%u step=%u: K%u main %u/%u, pack %u/%u\n", (unsigned)seed, step, k,
+                       (unsigned)test_log_main[i].tick, test_log_main[i].event, (unsigned)test_log_pack[j].tick,
+                       test_log_pack[j].event);
+                return false;
+            }
+            i++;
+            j++;
+        }
+        if (i < test_log_main_num || j < test_log_pack_num)
+        {
+            printf("pack seed=%u step=%u: K%u event count differs\n", (unsigned)seed, step, k);
+            return false;
+        }
+    }
+
+    printf("pack seed=%u step=%u: %u events ok\n", (unsigned)seed, step, (unsigned)test_log_main_num);
+    return test_log_main_num > 0 && test_log_main_num < TEST_LOG_SIZE;
+}
+
+/* ========================= 入口 ========================= */
+int main(int argc, char **argv)
+{
+    if (argc == 3 && (strcmp(argv[1], "golden") == 0 || strcmp(argv[1], "gen") == 0))
+    {
+        unsigned n = (unsigned)atoi(argv[2]);
+        const test_golden_t *golden;
+
+        if (n >= sizeof(test_golden) / sizeof(test_golden[0])) return 2;
+        golden = &test_golden[n];
+        Test_GoldenRun(golden);
+
+        if (argv[1][1] == 'e')
+        {
+            printf("    {%u, %u, %u, %s, 0x%08XUL, %u},\n", (unsigned)golden->seed, golden->max_step, golden->bounce,
+                   golden->combo ? "true" : "false", (unsigned)test_hash, (unsigned)test_count);
+            return 0;
+        }
+
+        printf("golden %u: hash 0x%08X, %u events", n, (unsigned)test_hash, (unsigned)test_count);
+        if (test_hash != golden->hash || test_count != golden->count)
+        {
+            printf(" (expected 0x%08X, %u) FAIL\n", (unsigned)golden->hash, (unsigned)golden->count);
+            return 1;
+        }
+        printf(" ok\n");
+        return 0;
+    }
+
+    if (argc == 4 && strcmp(argv[1], "pack") == 0)
+    {
+        return Test_PackRun((uint32_t)atoi(argv[2]), (uint8_t)atoi(argv[3])) ? 0 : 1;
+    }
+
+    printf("usage: %s golden <n> | gen <n> | pack <seed> <step>\n", argv[0]);
+    return 2;
+}
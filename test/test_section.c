@@ -0,0 +1,52 @@
+/**
+ * @file test_section.c
+ * @brief 链接段静态注册测试
+ * @details 以KEY_USE_SECTION=1编译并链接，检查NN_KEY_REGISTER/NN_COMBO_REGISTER生成的段
+ *          能被链接器生成的__start_/__stop_符号找到，首次调用处理函数时全部添加
+ *          用法: test_section
+ */
+
+#include <stdio.h>
+#include "NN_Key.h"
+
+#if !KEY_USE_SECTION
+#error "test_section.c must be built with -DKEY_USE_SECTION=1"
+#endif
+
+/* ========================= 静态注册 ========================= */
+static bool Test_ReadUp(void)
+{
+    return false;
+}
+
+static bool Test_ReadDown(void)
+{
+    return false;
+}
+
+NN_KEY_REGISTER(Test_KeyUp, "up", Test_ReadUp, NULL);
+NN_KEY_REGISTER(Test_KeyDown, "down", Test_ReadDown, NULL);
+#if KEY_USE_COMBO
+NN_COMBO_REGISTER(Test_ComboUpDown, "up+down", NULL, NULL, &Test_KeyUp, &Test_KeyDown);
+#endif
+
+/* ========================= 入口 ========================= */
+int main(void)
+{
+    bool ok = true;
+
+    // 处理函数首次调用时自动添加静态注册的按键和组合键
+    ok &= NN_Key_Handler(1);
+    ok &= NN_Key_Find("up") == &Test_KeyUp;
+    ok &= NN_Key_Find("down") == &Test_KeyDown;
+#if KEY_USE_COMBO
+    ok &= NN_Combo_Find("up+down") == &Test_ComboUpDown;
+#endif
+
+    // 已添加的注册项不会重复添加
+    ok &= NN_Key_RegisterAll();
+    ok &= NN_Key_Handler(2);
+
+    printf("section: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}